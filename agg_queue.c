@@ -0,0 +1,258 @@
+#include "agg_queue.h"
+#include <stdio.h>
+#include <string.h>
+
+#define AGG_QUEUE_ALLOCATION_ERROR "Memory allocation error for the aggregating queue\n"
+
+#define AGG_QUEUE_NULL_POINTER "Aggregating queue pointer parameter is NULL\n"
+
+#define NULL_COMPARE_POINTER "Param compare is null\n"
+
+#define NULL_AGG_FUNCTION "Lift and combine functions can't be NULL\n"
+
+/* ---------------------------------------------------------------------------
+ * Monotonic queue
+ * ------------------------------------------------------------------------- */
+
+MonoQueue * mono_queue_init(void (*destroy)(void * data), int (*compare)(void * a, void * b), MonoKind kind) {
+    if (!compare) {
+        fputs(NULL_COMPARE_POINTER, stderr);
+        return NULL;
+    }
+
+    MonoQueue * queue = malloc(sizeof(MonoQueue));
+    if (!queue) {
+        fputs(AGG_QUEUE_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    queue->queue = queue_init(destroy);
+    queue->candidates = deque_init(NULL, sizeof(MonoEntry));
+
+    if (!queue->queue || !queue->candidates) {
+        if (queue->queue) queue_terminate(queue->queue);
+        if (queue->candidates) deque_terminate(queue->candidates);
+        free(queue);
+        return NULL;
+    }
+
+    queue->compare = compare;
+    queue->sign = kind == MONO_MAX ? -1 : 1;
+    queue->front_seq = 0;
+    queue->next_seq = 0;
+    return queue;
+}
+
+void mono_queue_terminate(MonoQueue * queue) {
+    if (!queue) {
+        fputs(AGG_QUEUE_NULL_POINTER, stderr);
+        return;
+    }
+
+    queue_terminate(queue->queue);
+    deque_terminate(queue->candidates);
+    free(queue);
+}
+
+int mono_queue_enqueue(MonoQueue * queue, void * data) {
+    if (!queue) {
+        fputs(AGG_QUEUE_NULL_POINTER, stderr);
+        return 1;
+    }
+
+    MonoEntry entry = { data, queue->next_seq };
+
+    /* The entry takes its room first, so a failure leaves nothing to undo */
+    if (deque_push_back(queue->candidates, &entry))
+        return 1;
+
+    if (enqueue(queue->queue, data)) {
+        deque_pop_back(queue->candidates, NULL);
+        return 1;
+    }
+
+    /* Candidates after which comes a better element can't be the extreme
+     * anymore. A pop keeps its chunk as the deque spare, so pushing the new
+     * entry back can't fail. */
+    deque_pop_back(queue->candidates, NULL);
+    while (deque_num_elem(queue->candidates) > 0) {
+        MonoEntry * last = deque_back(queue->candidates);
+        if (queue->sign * queue->compare(last->data, data) <= 0)
+            break;
+        deque_pop_back(queue->candidates, NULL);
+    }
+    deque_push_back(queue->candidates, &entry);
+
+    queue->next_seq++;
+    return 0;
+}
+
+void mono_queue_dequeue(MonoQueue * queue) {
+    if (!queue) {
+        fputs(AGG_QUEUE_NULL_POINTER, stderr);
+        return;
+    } else if (list_num_elem(queue->queue) == 0) {
+        return;
+    }
+
+    MonoEntry * first = deque_front(queue->candidates);
+    if (first && first->seq == queue->front_seq)
+        deque_pop_front(queue->candidates, NULL);
+
+    dequeue(queue->queue);
+    queue->front_seq++;
+}
+
+void * mono_queue_extreme(MonoQueue * queue) {
+    if (!queue) {
+        fputs(AGG_QUEUE_NULL_POINTER, stderr);
+        return NULL;
+    }
+
+    MonoEntry * first = deque_front(queue->candidates);
+    return first ? first->data : NULL;
+}
+
+/* ---------------------------------------------------------------------------
+ * Aggregating queue
+ * ------------------------------------------------------------------------- */
+
+AggQueue * agg_queue_init(void (*destroy)(void * data), size_t agg_size,
+                          void (*lift)(void * out, void * data),
+                          void (*combine)(void * out, const void * older, const void * newer)) {
+    if (!lift || !combine || agg_size == 0) {
+        fputs(NULL_AGG_FUNCTION, stderr);
+        return NULL;
+    }
+
+    AggQueue * queue = malloc(sizeof(AggQueue));
+    if (!queue) {
+        fputs(AGG_QUEUE_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    queue->queue = queue_init(destroy);
+    queue->front = deque_init(NULL, agg_size);
+    queue->back = deque_init(NULL, agg_size);
+    queue->back_agg = malloc(agg_size);
+    queue->scratch = malloc(2 * agg_size);
+
+    if (!queue->queue || !queue->front || !queue->back || !queue->back_agg || !queue->scratch) {
+        fputs(AGG_QUEUE_ALLOCATION_ERROR, stderr);
+        if (queue->queue) queue_terminate(queue->queue);
+        if (queue->front) deque_terminate(queue->front);
+        if (queue->back) deque_terminate(queue->back);
+        free(queue->back_agg);
+        free(queue->scratch);
+        free(queue);
+        return NULL;
+    }
+
+    queue->agg_size = agg_size;
+    queue->lift = lift;
+    queue->combine = combine;
+    return queue;
+}
+
+void agg_queue_terminate(AggQueue * queue) {
+    if (!queue) {
+        fputs(AGG_QUEUE_NULL_POINTER, stderr);
+        return;
+    }
+
+    queue_terminate(queue->queue);
+    deque_terminate(queue->front);
+    deque_terminate(queue->back);
+    free(queue->back_agg);
+    free(queue->scratch);
+    free(queue);
+}
+
+int agg_queue_enqueue(AggQueue * queue, void * data) {
+    if (!queue) {
+        fputs(AGG_QUEUE_NULL_POINTER, stderr);
+        return 1;
+    }
+
+    queue->lift(queue->scratch, data);
+
+    /* The lifted value goes first, since it's the one that can be taken back */
+    if (deque_push_back(queue->back, queue->scratch))
+        return 1;
+
+    if (enqueue(queue->queue, data)) {
+        deque_pop_back(queue->back, NULL);
+        return 1;
+    }
+
+    if (deque_num_elem(queue->back) == 1) {
+        memcpy(queue->back_agg, queue->scratch, queue->agg_size);
+    } else {
+        char * total = (char *) queue->scratch + queue->agg_size;
+        queue->combine(total, queue->back_agg, queue->scratch);
+        memcpy(queue->back_agg, total, queue->agg_size);
+    }
+    return 0;
+}
+
+/* Moves the back part to the front, turning each lifted value into the
+ * aggregate from it to the newest element */
+static int flip(AggQueue * queue) {
+    int n = deque_num_elem(queue->back);
+
+    for (int i = n - 1; i >= 0; i--) {
+        void * single = deque_at(queue->back, i);
+
+        if (i < n - 1) {
+            queue->combine(queue->scratch, single, deque_front(queue->front));
+            single = queue->scratch;
+        }
+
+        if (deque_push_front(queue->front, single)) {
+            while (deque_num_elem(queue->front) > 0)
+                deque_pop_front(queue->front, NULL);
+            return 1;
+        }
+    }
+
+    while (deque_num_elem(queue->back) > 0)
+        deque_pop_back(queue->back, NULL);
+    return 0;
+}
+
+int agg_queue_dequeue(AggQueue * queue) {
+    if (!queue) {
+        fputs(AGG_QUEUE_NULL_POINTER, stderr);
+        return 1;
+    } else if (list_num_elem(queue->queue) == 0) {
+        return 1;
+    }
+
+    if (deque_num_elem(queue->front) == 0 && flip(queue))
+        return 1;
+
+    deque_pop_front(queue->front, NULL);
+    dequeue(queue->queue);
+    return 0;
+}
+
+int agg_queue_aggregate(AggQueue * queue, void * out) {
+    if (!queue) {
+        fputs(AGG_QUEUE_NULL_POINTER, stderr);
+        return 1;
+    }
+
+    int has_front = deque_num_elem(queue->front) > 0;
+    int has_back = deque_num_elem(queue->back) > 0;
+
+    if (has_front && has_back)
+        queue->combine(out, deque_front(queue->front), queue->back_agg);
+    else if (has_front)
+        memcpy(out, deque_front(queue->front), queue->agg_size);
+    else if (has_back)
+        memcpy(out, queue->back_agg, queue->agg_size);
+    else
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+#ifndef AGG_QUEUE_H
+#define AGG_QUEUE_H
+
+#include <stdint.h>
+#include "queue.h"
+#include "deque.h"
+
+/**
+ * @file agg_queue.h
+ * @brief Queues that answer sliding window minimum, maximum and aggregates.
+ *
+ * A queue used as a sliding window (enqueue the new sample, dequeue the
+ * oldest) can be asked about all the samples it holds in amortized O(1)
+ * instead of rescanning them:
+ *
+ *  - MonoQueue keeps, next to the elements, the increasing (or decreasing)
+ *    run of candidates for the minimum (or maximum): an element followed by a
+ *    smaller one can never be the minimum again, so it's dropped from the
+ *    candidates on enqueue. The minimum is the first candidate.
+ *
+ *  - AggQueue keeps any associative aggregate (sum, minimum, gcd, ...) with
+ *    the two stacks technique. New elements go to the back part, which keeps
+ *    one running aggregate. The front part keeps, for each element, the
+ *    aggregate from it to the end of the part, so dequeuing just drops one.
+ *    When the front part runs out, the back part is turned into a new front
+ *    part in a single pass. Every element is lifted once and combined at most
+ *    twice, so operations are amortized O(1) whatever the aggregate.
+ *
+ * Aggregates are values of agg_size bytes built by two user functions:
+ *
+ *  - lift(out, data) writes the aggregate of a single element.
+ *  - combine(out, older, newer) writes the aggregate of two consecutive runs
+ *    of elements, older being the one enqueued first. The operation must be
+ *    associative but needn't be commutative. out never overlaps the inputs.
+ *
+ * The elements themselves live in a regular Queue, with the enqueue and
+ * dequeue semantics of the queue module.
+ */
+
+/**
+ * @brief Which extreme a MonoQueue tracks
+ */
+typedef enum MonoKind {
+    MONO_MIN,
+    MONO_MAX
+} MonoKind;
+
+/**
+ * @brief A candidate of a MonoQueue: an element and its position in the queue
+ */
+typedef struct MonoEntry {
+    void * data;
+    uint64_t seq;
+} MonoEntry;
+
+/**
+ * @brief The monotonic queue structure
+ */
+typedef struct MonoQueue {
+    Queue * queue;                  //the elements
+    Deque * candidates;             //MonoEntry of the elements that may still be the extreme
+    int (*compare)(void * a, void * b);
+    int sign;                       //1 for the minimum, -1 for the maximum
+    uint64_t front_seq;             //position of the element at the front
+    uint64_t next_seq;              //position the next enqueued element gets
+} MonoQueue;
+
+/**
+ * @brief The aggregating queue structure
+ */
+typedef struct AggQueue {
+    Queue * queue;                  //the elements
+    Deque * front;                  //aggregate from each front part element to the end of the part
+    Deque * back;                   //aggregate of each back part element on its own
+    void * back_agg;                //aggregate of the whole back part
+    void * scratch;                 //room for two aggregates
+    size_t agg_size;                //length in bytes of an aggregate
+    void (*lift)(void * out, void * data);
+    void (*combine)(void * out, const void * older, const void * newer);
+} AggQueue;
+
+/**
+ * @brief Initializes a new monotonic queue
+ *
+ * @param destroy Element destructor, called on dequeue and terminate, or NULL.
+ *
+ * @param compare Order of the elements, analogue to strcmp
+ *
+ * @param kind MONO_MIN to track the minimum, MONO_MAX for the maximum
+ *
+ * @return A pointer to the new queue, or NULL on error.
+ */
+MonoQueue * mono_queue_init(void (*destroy)(void * data), int (*compare)(void * a, void * b), MonoKind kind);
+
+/**
+ * @brief Destroys the queue and every element left
+ */
+void mono_queue_terminate(MonoQueue * queue);
+
+/**
+ * @brief Enqueues an element at the back
+ *
+ * @return 0 if the element was added, 1 otherwise.
+ */
+int mono_queue_enqueue(MonoQueue * queue, void * data);
+
+/**
+ * @brief Dequeues the element at the front, destroying it if the queue has a
+ *        destroy function
+ */
+void mono_queue_dequeue(MonoQueue * queue);
+
+/**
+ * @brief The minimum or maximum element, the oldest one among equals
+ *
+ * @return Its data, or NULL if the queue is empty.
+ */
+void * mono_queue_extreme(MonoQueue * queue);
+
+#define mono_queue_num_elem(q) list_num_elem((q)->queue)
+
+/**
+ * @brief Initializes a new aggregating queue
+ *
+ * @param destroy Element destructor, called on dequeue and terminate, or NULL.
+ *
+ * @param agg_size Size in bytes of an aggregate
+ *
+ * @param lift Writes the aggregate of one element
+ *
+ * @param combine Writes the aggregate of two consecutive runs, see above
+ *
+ * @return A pointer to the new queue, or NULL on error.
+ */
+AggQueue * agg_queue_init(void (*destroy)(void * data), size_t agg_size,
+                          void (*lift)(void * out, void * data),
+                          void (*combine)(void * out, const void * older, const void * newer));
+
+/**
+ * @brief Destroys the queue and every element left
+ */
+void agg_queue_terminate(AggQueue * queue);
+
+/**
+ * @brief Enqueues an element at the back
+ *
+ * @return 0 if the element was added, 1 otherwise.
+ */
+int agg_queue_enqueue(AggQueue * queue, void * data);
+
+/**
+ * @brief Dequeues the element at the front, destroying it if the queue has a
+ *        destroy function
+ *
+ * @return 0 if an element was removed, 1 if the queue is empty or memory
+ *         allocation fails, in which case the queue is left untouched.
+ */
+int agg_queue_dequeue(AggQueue * queue);
+
+/**
+ * @brief Aggregate of every element in the queue, oldest first
+ *
+ * @param out Where the agg_size bytes of the aggregate are written
+ *
+ * @return 0 on success, 1 if the queue is empty.
+ */
+int agg_queue_aggregate(AggQueue * queue, void * out);
+
+#define agg_queue_num_elem(q) list_num_elem((q)->queue)
+
+#endif
@@ -0,0 +1,104 @@
+#include "agg_stack.h"
+#include <stdio.h>
+#include <string.h>
+
+#define AGG_STACK_ALLOCATION_ERROR "Memory allocation error for the aggregating stack\n"
+
+#define AGG_STACK_NULL_POINTER "Aggregating stack pointer parameter is NULL\n"
+
+#define NULL_AGG_FUNCTION "Lift and combine functions can't be NULL\n"
+
+AggStack * agg_stack_init(void (*destroy)(void * data), size_t agg_size,
+                          void (*lift)(void * out, void * data),
+                          void (*combine)(void * out, const void * older, const void * newer)) {
+    if (!lift || !combine || agg_size == 0) {
+        fputs(NULL_AGG_FUNCTION, stderr);
+        return NULL;
+    }
+
+    AggStack * stack = malloc(sizeof(AggStack));
+    if (!stack) {
+        fputs(AGG_STACK_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    stack->stack = stack_init(destroy);
+    stack->aggs = deque_init(NULL, agg_size);
+    stack->scratch = malloc(2 * agg_size);
+
+    if (!stack->stack || !stack->aggs || !stack->scratch) {
+        fputs(AGG_STACK_ALLOCATION_ERROR, stderr);
+        if (stack->stack) stack_terminate(stack->stack);
+        if (stack->aggs) deque_terminate(stack->aggs);
+        free(stack->scratch);
+        free(stack);
+        return NULL;
+    }
+
+    stack->agg_size = agg_size;
+    stack->lift = lift;
+    stack->combine = combine;
+    return stack;
+}
+
+void agg_stack_terminate(AggStack * stack) {
+    if (!stack) {
+        fputs(AGG_STACK_NULL_POINTER, stderr);
+        return;
+    }
+
+    stack_terminate(stack->stack);
+    deque_terminate(stack->aggs);
+    free(stack->scratch);
+    free(stack);
+}
+
+int agg_stack_push(AggStack * stack, void * data) {
+    if (!stack) {
+        fputs(AGG_STACK_NULL_POINTER, stderr);
+        return 1;
+    }
+
+    char * single = stack->scratch;
+    char * total = single + stack->agg_size;
+    void * below = deque_num_elem(stack->aggs) ? deque_back(stack->aggs) : NULL;
+
+    stack->lift(single, data);
+    if (below)
+        stack->combine(total, below, single);
+    else
+        memcpy(total, single, stack->agg_size);
+
+    /* The aggregate goes first, since it's the one that can be taken back */
+    if (deque_push_back(stack->aggs, total))
+        return 1;
+
+    if (push(stack->stack, data)) {
+        deque_pop_back(stack->aggs, NULL);
+        return 1;
+    }
+
+    return 0;
+}
+
+void agg_stack_pop(AggStack * stack) {
+    if (!stack) {
+        fputs(AGG_STACK_NULL_POINTER, stderr);
+        return;
+    }
+
+    pop(stack->stack);
+    deque_pop_back(stack->aggs, NULL);
+}
+
+int agg_stack_aggregate(AggStack * stack, void * out) {
+    if (!stack) {
+        fputs(AGG_STACK_NULL_POINTER, stderr);
+        return 1;
+    } else if (deque_num_elem(stack->aggs) == 0) {
+        return 1;
+    }
+
+    memcpy(out, deque_back(stack->aggs), stack->agg_size);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#ifndef AGG_STACK_H
+#define AGG_STACK_H
+
+#include "stack.h"
+#include "deque.h"
+
+/**
+ * @file agg_stack.h
+ * @brief Stack that keeps the aggregate of its elements up to date.
+ *
+ * Next to each element, the stack keeps the aggregate of that element and all
+ * the ones below it. Pushing combines the new element with the aggregate
+ * below, and popping just drops the top aggregate, so the aggregate of the
+ * whole stack is always at hand in O(1).
+ *
+ * The aggregate is any associative operation: minimum, maximum, sum, gcd,
+ * matrix product... Aggregates are values of agg_size bytes built by two user
+ * functions:
+ *
+ *  - lift(out, data) writes the aggregate of a single element.
+ *  - combine(out, older, newer) writes the aggregate of two consecutive runs
+ *    of elements, older being the one pushed first. out never overlaps them.
+ *
+ * The elements themselves live in a regular Stack, with the push and pop
+ * semantics of the stack module.
+ */
+
+/**
+ * @brief The aggregating stack structure
+ */
+typedef struct AggStack {
+    Stack * stack;                  //the elements
+    Deque * aggs;                   //aggregate of each element and the ones below it, bottom first
+    size_t agg_size;                //length in bytes of an aggregate
+    void (*lift)(void * out, void * data);
+    void (*combine)(void * out, const void * older, const void * newer);
+    void * scratch;                 //room for two aggregates
+} AggStack;
+
+/**
+ * @brief Initializes a new aggregating stack
+ *
+ * @param destroy Element destructor, called on pop and terminate, or NULL.
+ *
+ * @param agg_size Size in bytes of an aggregate
+ *
+ * @param lift Writes the aggregate of one element
+ *
+ * @param combine Writes the aggregate of two consecutive runs, see above
+ *
+ * @return A pointer to the new stack, or NULL on error.
+ */
+AggStack * agg_stack_init(void (*destroy)(void * data), size_t agg_size,
+                          void (*lift)(void * out, void * data),
+                          void (*combine)(void * out, const void * older, const void * newer));
+
+/**
+ * @brief Destroys the stack and every element left
+ */
+void agg_stack_terminate(AggStack * stack);
+
+/**
+ * @brief Pushes a new element on the stack
+ *
+ * @return 0 if the element was pushed, 1 otherwise.
+ */
+int agg_stack_push(AggStack * stack, void * data);
+
+/**
+ * @brief Pops the top element, destroying it if the stack has a destroy function
+ */
+void agg_stack_pop(AggStack * stack);
+
+/**
+ * @brief Aggregate of every element in the stack
+ *
+ * @param out Where the agg_size bytes of the aggregate are written
+ *
+ * @return 0 on success, 1 if the stack is empty.
+ */
+int agg_stack_aggregate(AggStack * stack, void * out);
+
+/**
+ * @brief Data of the top element, or NULL if the stack is empty
+ */
+#define agg_stack_peek(s) (list_num_elem((s)->stack) ? list_head((s)->stack)->next->data : NULL)
+
+#define agg_stack_num_elem(s) list_num_elem((s)->stack)
+
+#endif
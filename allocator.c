@@ -0,0 +1,19 @@
+#include "allocator.h"
+#include <stdlib.h>
+
+static void * libc_alloc(size_t size, void * ctx) {
+    (void) ctx;
+    return malloc(size);
+}
+
+static void * libc_realloc(void * ptr, size_t size, void * ctx) {
+    (void) ctx;
+    return realloc(ptr, size);
+}
+
+static void libc_free(void * ptr, void * ctx) {
+    (void) ctx;
+    free(ptr);
+}
+
+const Allocator allocator_libc = { libc_alloc, libc_realloc, libc_free, NULL };
@@ -0,0 +1,55 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stddef.h>
+
+/**
+ * @file allocator.h
+ * @brief Pluggable memory allocator for the containers.
+ *
+ * Containers created with one of the *_init_with functions get the memory
+ * they own (the structure, nodes, node blocks and element buffers) from the
+ * given allocator instead of the C library. Temporary buffers used inside a
+ * single call, such as sort scratch memory, still come from the C library.
+ *
+ * An allocator must outlive every container using it. All the functions get
+ * the allocator context as their last parameter.
+ *
+ * An allocator may have no free function when its memory is only released all
+ * at once by its owner, as a region does. Containers then skip the walk over
+ * their nodes on termination, unless they have elements to destroy.
+ */
+
+/**
+ * @brief The allocator vtable
+ */
+typedef struct Allocator {
+    void * (*alloc)(size_t size, void * ctx);                  /**< Like malloc. */
+    void * (*realloc)(void * ptr, size_t size, void * ctx);    /**< Like realloc. */
+    void (*free)(void * ptr, void * ctx);                      /**< Like free, or NULL for bulk release. */
+    void * ctx;                                                 /**< User context of the allocator. */
+} Allocator;
+
+/**
+ * @brief The default allocator, backed by malloc, realloc and free
+ */
+extern const Allocator allocator_libc;
+
+/**
+ * @brief Allocator to use when NULL is given: the default one
+ */
+#define allocator_or_default(allocator) ((allocator) ? (allocator) : &allocator_libc)
+
+#define allocator_alloc(allocator, size) ((allocator)->alloc((size), (allocator)->ctx))
+
+#define allocator_realloc(allocator, ptr, size) ((allocator)->realloc((ptr), (size), (allocator)->ctx))
+
+#define allocator_free(allocator, ptr) \
+    ((allocator)->free ? (allocator)->free((ptr), (allocator)->ctx) : (void) 0)
+
+/**
+ * @brief Whether the memory is released all at once instead of block by block
+ */
+#define allocator_frees_in_bulk(allocator) ((allocator)->free == NULL)
+
+#endif
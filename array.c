@@ -2,58 +2,836 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 #define ARRAY_ALLOCATION_ERROR "Memory allocation error for the array"
 
 #define ARRAY_LIST_ALLOCATION_ERROR "Error in memory allocation for array data for specified length"
 
 #define ARRAY_NULL_POINTER "Array pointer parameter is NULL"
 
+#define ARRAY_NULL_COMPARE "Param compare is null"
+
+#define ARRAY_INVALID_STORAGE "Invalid storage for the array"
+
+#define ARRAY_MAPPED_GROWTH "A mapped array can't be grown"
+
 Array * array_init(void (*destroy)(void * data), int init_size, size_t elem_size) {
-    Array * array = malloc(sizeof(Array));
+    return array_init_with(destroy, init_size, elem_size, NULL);
+}
+
+Array * array_init_with(void (*destroy)(void * data), int init_size, size_t elem_size,
+                        const Allocator * allocator) {
+    size_t capacity = init_size > 0 ? (size_t) init_size : 0;
+    size_t bytes = ARRAY_INLINE_OFFSET + capacity * elem_size;
+
+    allocator = allocator_or_default(allocator);
+
+    /* Structure and elements in one allocation, the elements right after the
+     * structure at the strictest alignment */
+    Array * array = allocator_alloc(allocator, bytes);
     if (!array) {
         fputs(ARRAY_ALLOCATION_ERROR, stderr);
         return NULL;
     }
+    memset(array, 0, bytes);
 
-    array->destroy = destroy;
+    array_init_in_place(array, (char *) array + ARRAY_INLINE_OFFSET, (int) capacity, elem_size, destroy);
+    array->flags = ARRAY_HEAP_HEADER;
+    array->allocator = allocator;
 
-    if (init_size > 0) {
-        array->list = calloc(init_size, elem_size);
-        if (!array->list) {
-            fputs(ARRAY_LIST_ALLOCATION_ERROR, stderr);
-            free(array);
-            return NULL;
-        }
-        return array;
-    }
-    else {
-        array->list = calloc(10, elem_size);
-        if (!array->list) {
-            fputs(ARRAY_LIST_ALLOCATION_ERROR, stderr);
-            free(array);
-            return NULL;
-        }
-        return array;
+    return array;
+}
+
+Array * array_init_in_place(Array * array, void * storage, int capacity, size_t elem_size,
+                            void (*destroy)(void * data)) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return NULL;
+    } else if (capacity < 0 || (capacity > 0 && !storage)) {
+        fputs(ARRAY_INVALID_STORAGE, stderr);
+        return NULL;
     }
+
+    array->list = storage;
+    array->num_elem = 0;
+    array->total_size = capacity;
+    array->elem_size = elem_size;
+    array->destroy = destroy;
+    array->filter = NULL;
+    array->flags = 0;
+    array->allocator = &allocator_libc;
+
+    return array;
 }
 
-void array_reallocate(Array * array, int new_size) {
+int array_reallocate(Array * array, int new_size) {
     if (!array) {
         fputs(ARRAY_NULL_POINTER, stderr);
-        return ;
+        return 1;
     } else if (new_size <= array->total_size) 
-        return ;
+        return 0;
+    else if (array->flags & ARRAY_MAPPED) {
+        /* The list lives in the file mapping, which array_unmap releases */
+        fputs(ARRAY_MAPPED_GROWTH, stderr);
+        return 1;
+    }
     
-    void * new_list = calloc(new_size, array->elem_size);
+    size_t old_bytes = (size_t) array->total_size * array->elem_size;
+    size_t new_bytes = (size_t) new_size * array->elem_size;
+    void * new_list;
+
+    /* Inline or caller storage is left alone, only a heap buffer is resized */
+    if (array->flags & ARRAY_HEAP_LIST) {
+        new_list = allocator_realloc(array->allocator, array->list, new_bytes);
+    } else {
+        new_list = allocator_alloc(array->allocator, new_bytes);
+        if (new_list && old_bytes > 0)
+            memcpy(new_list, array->list, old_bytes);
+    }
+
     if (!new_list) {
         fputs(ARRAY_LIST_ALLOCATION_ERROR, stderr);
-        return ;
+        return 1;
     }
 
-    memcpy(new_list, array->list, array->total_size * array->elem_size);
-    
-    free(array->list);
+    memset((char *) new_list + old_bytes, 0, new_bytes - old_bytes);
 
     array->list = new_list;
     array->total_size = new_size;
+    array->flags |= ARRAY_HEAP_LIST;
+    return 0;
+}
+
+void array_terminate(Array * array) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return;
+    }
+
+    if (array->destroy) {
+        char * elem = array->list;
+        for (int i = 0; i < array->num_elem; i++, elem += array->elem_size)
+            array->destroy(elem);
+    }
+
+    if (array->filter)
+        bloom_terminate(array->filter);
+
+    if (array->flags & ARRAY_HEAP_LIST)
+        allocator_free(array->allocator, array->list);
+    if (array->flags & ARRAY_HEAP_HEADER)
+        allocator_free(array->allocator, array);
+}
+
+#define ARRAY_INDEX_OUT_OF_RANGE "Index out of the array range"
+
+#define ARRAY_NULL_DATA "Data pointer parameter is NULL"
+
+#define ARRAY_EMPTY_REMOVAL "No removal on an empty array"
+
+#define ARRAY_AT(array, i) ((char *) (array)->list + (size_t) (i) * (array)->elem_size)
+
+/* Makes room for one more element, doubling the length when full */
+static int array_reserve_one(Array * array) {
+    if (array->num_elem < array->total_size)
+        return 0;
+
+    return array_reallocate(array, array->total_size > 0 ? 2 * array->total_size : 10);
+}
+
+int array_insert_at(Array * array, int index, void * data) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (!data) {
+        fputs(ARRAY_NULL_DATA, stderr);
+        return 1;
+    } else if (index < 0 || index > array->num_elem) {
+        fputs(ARRAY_INDEX_OUT_OF_RANGE, stderr);
+        return 1;
+    } else if (array_reserve_one(array)) {
+        return 1;
+    }
+
+    memmove(ARRAY_AT(array, index + 1), ARRAY_AT(array, index),
+            (size_t) (array->num_elem - index) * array->elem_size);
+    memcpy(ARRAY_AT(array, index), data, array->elem_size);
+    array->num_elem++;
+
+    if (array->filter)
+        bloom_add(array->filter, ARRAY_AT(array, index));
+
+    return 0;
+}
+
+int array_append(Array * array, void * data) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    }
+
+    return array_insert_at(array, array->num_elem, data);
+}
+
+int array_append_n(Array * array, const void * data, int n) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (n <= 0) {
+        return 0;
+    } else if (!data) {
+        fputs(ARRAY_NULL_DATA, stderr);
+        return 1;
+    } else if (n > INT_MAX - array->num_elem) {
+        fputs(ARRAY_LIST_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    /* One growth for the whole batch, at least doubling as appends do */
+    if (array->num_elem + n > array->total_size) {
+        int wanted = array->total_size < INT_MAX / 2 ? 2 * array->total_size : INT_MAX;
+        if (array_reallocate(array, wanted > array->num_elem + n ? wanted : array->num_elem + n))
+            return 1;
+    }
+
+    memcpy(ARRAY_AT(array, array->num_elem), data, (size_t) n * array->elem_size);
+
+    if (array->filter)
+        for (int i = array->num_elem; i < array->num_elem + n; i++)
+            bloom_add(array->filter, ARRAY_AT(array, i));
+
+    array->num_elem += n;
+    return 0;
+}
+
+int array_sorted_insert(Array * array, void * data, int (*compare)(void*a, void*b)) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return ARRAY_INSERT_FAILED;
+    } else if (!compare) {
+        fputs(ARRAY_NULL_COMPARE, stderr);
+        return ARRAY_INSERT_FAILED;
+    }
+
+    /* The array being sorted, the first element not lower than data is found
+     * by binary search rather than scanning */
+    int lo = 0, hi = array->num_elem;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (compare(ARRAY_AT(array, mid), data) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo < array->num_elem && compare(ARRAY_AT(array, lo), data) == 0)
+        return lo;
+
+    return array_insert_at(array, lo, data) ? ARRAY_INSERT_FAILED : -1;
+}
+
+int array_remove_at(Array * array, int index) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (array->num_elem == 0) {
+        fputs(ARRAY_EMPTY_REMOVAL, stderr);
+        return 1;
+    } else if (index < 0 || index >= array->num_elem) {
+        fputs(ARRAY_INDEX_OUT_OF_RANGE, stderr);
+        return 1;
+    }
+
+    if (array->destroy)
+        array->destroy(ARRAY_AT(array, index));
+
+    memmove(ARRAY_AT(array, index), ARRAY_AT(array, index + 1),
+            (size_t) (array->num_elem - index - 1) * array->elem_size);
+    array->num_elem--;
+
+    if (array->filter)
+        bloom_invalidate(array->filter);
+
+    return 0;
+}
+
+int array_remove_last(Array * array) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    }
+
+    return array_remove_at(array, array->num_elem - 1);
+}
+
+/* Refills the filter with every element of the array */
+static int array_filter_fill(Array * array) {
+    if (bloom_reset(array->filter, 2 * array->num_elem))
+        return 1;
+
+    for (int i = 0; i < array->num_elem; i++)
+        bloom_add(array->filter, ARRAY_AT(array, i));
+
+    return 0;
+}
+
+int array_attach_filter(Array * array, uint64_t (*hash)(void * elem), double fp_rate, size_t max_bytes) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    }
+
+    Bloom * filter = bloom_init(hash, 2 * array->num_elem, fp_rate, max_bytes);
+    if (!filter)
+        return 1;
+
+    if (array->filter)
+        bloom_terminate(array->filter);
+    array->filter = filter;
+
+    /* Fresh filter of the right size: filling it can't fail */
+    array_filter_fill(array);
+    return 0;
+}
+
+void array_detach_filter(Array * array) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return;
+    }
+
+    if (array->filter)
+        bloom_terminate(array->filter);
+    array->filter = NULL;
+}
+
+void * array_search(Array * array, void * x, int (*compare)(void*a, void*b)) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return NULL;
+    } else if (!compare) {
+        fputs(ARRAY_NULL_COMPARE, stderr);
+        return NULL;
+    }
+
+    /* A stale filter is rebuilt first; if that fails the array is scanned */
+    if (array->filter && (!bloom_stale(array->filter) || !array_filter_fill(array))
+        && !bloom_may_contain(array->filter, x))
+        return NULL;
+
+    char * elem = array->list;
+    for (int i = 0; i < array->num_elem; i++, elem += array->elem_size) {
+        if (!compare(elem, x))
+            return elem;
+    }
+    return NULL;
+}
+
+#undef ARRAY_AT
+
+/* ---------------------------------------------------------------------------
+ * Sorting
+ * ------------------------------------------------------------------------- */
+
+#define ARRAY_RADIX_KEY_SIZE "Elements size does not match the radix key size and no key extractor was given"
+
+/* Partitions below this length are finished with insertion sort */
+#define SORT_INSERTION_THRESHOLD 24
+
+/* Partitions above this length pick the pivot as a pseudomedian of nine */
+#define SORT_NINTHER_THRESHOLD 128
+
+/* Maximum number of moves partial insertion sort may do before giving up */
+#define SORT_PARTIAL_INSERTION_LIMIT 8
+
+typedef void (*array_swap_fn)(void * a, void * b, size_t size);
+
+static void swap_4(void * a, void * b, size_t size) {
+    (void) size;
+    uint32_t t;
+    memcpy(&t, a, 4); memcpy(a, b, 4); memcpy(b, &t, 4);
+}
+
+static void swap_8(void * a, void * b, size_t size) {
+    (void) size;
+    uint64_t t;
+    memcpy(&t, a, 8); memcpy(a, b, 8); memcpy(b, &t, 8);
+}
+
+static void swap_16(void * a, void * b, size_t size) {
+    (void) size;
+    uint64_t t[2];
+    memcpy(t, a, 16); memcpy(a, b, 16); memcpy(b, t, 16);
+}
+
+static void swap_words(void * a, void * b, size_t size) {
+    unsigned char * pa = a, * pb = b;
+    uint64_t t;
+
+    for (; size >= 8; size -= 8, pa += 8, pb += 8) {
+        memcpy(&t, pa, 8); memcpy(pa, pb, 8); memcpy(pb, &t, 8);
+    }
+    for (; size > 0; size--, pa++, pb++) {
+        unsigned char c = *pa; *pa = *pb; *pb = c;
+    }
+}
+
+static array_swap_fn swap_for_size(size_t size) {
+    switch (size) {
+        case 4:  return swap_4;
+        case 8:  return swap_8;
+        case 16: return swap_16;
+        default: return swap_words;
+    }
+}
+
+/* Everything the pdqsort routines need, so they only pass indices around */
+typedef struct SortCtx {
+    char * base;
+    size_t size;
+    int (*compare)(void * a, void * b);
+    array_swap_fn swap;
+    void * tmp;                     /* scratch space for one element */
+} SortCtx;
+
+#define AT(ctx, i) ((ctx)->base + (size_t)(i) * (ctx)->size)
+#define LESS(ctx, i, j) ((ctx)->compare(AT(ctx, i), AT(ctx, j)) < 0)
+#define SWAP(ctx, i, j) ((ctx)->swap(AT(ctx, i), AT(ctx, j), (ctx)->size))
+
+static void insertion_sort(SortCtx * ctx, size_t begin, size_t end) {
+    for (size_t cur = begin + 1; cur < end; cur++) {
+        if (!LESS(ctx, cur, cur - 1))
+            continue;
+
+        size_t sift = cur;
+        memcpy(ctx->tmp, AT(ctx, cur), ctx->size);
+        do {
+            memcpy(AT(ctx, sift), AT(ctx, sift - 1), ctx->size);
+            sift--;
+        } while (sift != begin && ctx->compare(ctx->tmp, AT(ctx, sift - 1)) < 0);
+        memcpy(AT(ctx, sift), ctx->tmp, ctx->size);
+    }
+}
+
+/* Same as insertion_sort, but the element at begin - 1 must be lower or
+ * equal than every element in [begin, end), so it acts as a sentinel */
+static void unguarded_insertion_sort(SortCtx * ctx, size_t begin, size_t end) {
+    for (size_t cur = begin + 1; cur < end; cur++) {
+        if (!LESS(ctx, cur, cur - 1))
+            continue;
+
+        size_t sift = cur;
+        memcpy(ctx->tmp, AT(ctx, cur), ctx->size);
+        do {
+            memcpy(AT(ctx, sift), AT(ctx, sift - 1), ctx->size);
+            sift--;
+        } while (ctx->compare(ctx->tmp, AT(ctx, sift - 1)) < 0);
+        memcpy(AT(ctx, sift), ctx->tmp, ctx->size);
+    }
+}
+
+/* Insertion sort that gives up once it has moved too many elements.
+ * Returns 1 if the range got sorted, 0 otherwise */
+static int partial_insertion_sort(SortCtx * ctx, size_t begin, size_t end) {
+    size_t limit = 0;
+
+    for (size_t cur = begin + 1; cur < end; cur++) {
+        if (!LESS(ctx, cur, cur - 1))
+            continue;
+
+        size_t sift = cur;
+        memcpy(ctx->tmp, AT(ctx, cur), ctx->size);
+        do {
+            memcpy(AT(ctx, sift), AT(ctx, sift - 1), ctx->size);
+            sift--;
+        } while (sift != begin && ctx->compare(ctx->tmp, AT(ctx, sift - 1)) < 0);
+        memcpy(AT(ctx, sift), ctx->tmp, ctx->size);
+
+        limit += cur - sift;
+        if (limit > SORT_PARTIAL_INSERTION_LIMIT)
+            return 0;
+    }
+    return 1;
+}
+
+static void sift_down(SortCtx * ctx, size_t begin, size_t root, size_t len) {
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= len)
+            return;
+        if (child + 1 < len && LESS(ctx, begin + child, begin + child + 1))
+            child++;
+        if (!LESS(ctx, begin + root, begin + child))
+            return;
+        SWAP(ctx, begin + root, begin + child);
+        root = child;
+    }
+}
+
+static void heap_sort(SortCtx * ctx, size_t begin, size_t end) {
+    size_t len = end - begin;
+
+    for (size_t i = len / 2; i-- > 0;)
+        sift_down(ctx, begin, i, len);
+
+    for (size_t i = len - 1; i > 0; i--) {
+        SWAP(ctx, begin, begin + i);
+        sift_down(ctx, begin, 0, i);
+    }
+}
+
+static void sort2(SortCtx * ctx, size_t a, size_t b) {
+    if (LESS(ctx, b, a))
+        SWAP(ctx, a, b);
+}
+
+static void sort3(SortCtx * ctx, size_t a, size_t b, size_t c) {
+    sort2(ctx, a, b);
+    sort2(ctx, b, c);
+    sort2(ctx, a, b);
+}
+
+/* Partitions [begin, end) around the pivot at begin. Elements equal to the
+ * pivot go to the right side. Returns the final pivot position and sets
+ * already_partitioned when no swap was needed. */
+static size_t partition_right(SortCtx * ctx, size_t begin, size_t end, int * already_partitioned) {
+    size_t first = begin, last = end;
+
+    /* The median-of-three guarantees an element >= pivot exists */
+    while (LESS(ctx, ++first, begin));
+
+    if (first - 1 == begin)
+        while (first < last && !LESS(ctx, --last, begin));
+    else
+        while (!LESS(ctx, --last, begin));
+
+    *already_partitioned = first >= last;
+
+    while (first < last) {
+        SWAP(ctx, first, last);
+        while (LESS(ctx, ++first, begin));
+        while (!LESS(ctx, --last, begin));
+    }
+
+    size_t pivot_pos = first - 1;
+    SWAP(ctx, begin, pivot_pos);
+    return pivot_pos;
+}
+
+/* Like partition_right, but elements equal to the pivot go to the left.
+ * Used when the pivot equals the element before the range, in which case
+ * the whole left side is known to be equal and is never touched again. */
+static size_t partition_left(SortCtx * ctx, size_t begin, size_t end) {
+    size_t first = begin, last = end;
+
+    while (LESS(ctx, begin, --last));
+
+    if (last + 1 == end)
+        while (first < last && !LESS(ctx, begin, ++first));
+    else
+        while (!LESS(ctx, begin, ++first));
+
+    while (first < last) {
+        SWAP(ctx, first, last);
+        while (LESS(ctx, begin, --last));
+        while (!LESS(ctx, begin, ++first));
+    }
+
+    SWAP(ctx, begin, last);
+    return last;
+}
+
+static void pdqsort_loop(SortCtx * ctx, size_t begin, size_t end, int bad_allowed, int leftmost) {
+    for (;;) {
+        size_t size = end - begin;
+
+        if (size < SORT_INSERTION_THRESHOLD) {
+            if (leftmost)
+                insertion_sort(ctx, begin, end);
+            else
+                unguarded_insertion_sort(ctx, begin, end);
+            return;
+        }
+
+        /* Choose the pivot and leave it at begin */
+        size_t s2 = size / 2;
+        if (size > SORT_NINTHER_THRESHOLD) {
+            sort3(ctx, begin, begin + s2, end - 1);
+            sort3(ctx, begin + 1, begin + s2 - 1, end - 2);
+            sort3(ctx, begin + 2, begin + s2 + 1, end - 3);
+            sort3(ctx, begin + s2 - 1, begin + s2, begin + s2 + 1);
+            SWAP(ctx, begin, begin + s2);
+        } else {
+            sort3(ctx, begin + s2, begin, end - 1);
+        }
+
+        /* If the pivot equals the element before this range, everything
+         * equal to it can be put aside at once */
+        if (!leftmost && !LESS(ctx, begin - 1, begin)) {
+            begin = partition_left(ctx, begin, end) + 1;
+            continue;
+        }
+
+        int already_partitioned;
+        size_t pivot_pos = partition_right(ctx, begin, end, &already_partitioned);
+
+        size_t l_size = pivot_pos - begin;
+        size_t r_size = end - (pivot_pos + 1);
+
+        if (l_size < size / 8 || r_size < size / 8) {
+            /* Too many bad partitions: fall back to heap sort */
+            if (--bad_allowed == 0) {
+                heap_sort(ctx, begin, end);
+                return;
+            }
+
+            /* Break patterns that lead to bad pivots */
+            if (l_size >= SORT_INSERTION_THRESHOLD) {
+                SWAP(ctx, begin, begin + l_size / 4);
+                SWAP(ctx, pivot_pos - 1, pivot_pos - l_size / 4);
+                if (l_size > SORT_NINTHER_THRESHOLD) {
+                    SWAP(ctx, begin + 1, begin + (l_size / 4 + 1));
+                    SWAP(ctx, begin + 2, begin + (l_size / 4 + 2));
+                    SWAP(ctx, pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+                    SWAP(ctx, pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+                }
+            }
+            if (r_size >= SORT_INSERTION_THRESHOLD) {
+                SWAP(ctx, pivot_pos + 1, pivot_pos + 1 + r_size / 4);
+                SWAP(ctx, end - 1, end - r_size / 4);
+                if (r_size > SORT_NINTHER_THRESHOLD) {
+                    SWAP(ctx, pivot_pos + 2, pivot_pos + 2 + r_size / 4);
+                    SWAP(ctx, pivot_pos + 3, pivot_pos + 3 + r_size / 4);
+                    SWAP(ctx, end - 2, end - (1 + r_size / 4));
+                    SWAP(ctx, end - 3, end - (2 + r_size / 4));
+                }
+            }
+        } else if (already_partitioned
+                   && partial_insertion_sort(ctx, begin, pivot_pos)
+                   && partial_insertion_sort(ctx, pivot_pos + 1, end)) {
+            /* Input looked sorted and it was */
+            return;
+        }
+
+        /* Recurse on the left side, loop on the right one */
+        pdqsort_loop(ctx, begin, pivot_pos, bad_allowed, leftmost);
+        begin = pivot_pos + 1;
+        leftmost = 0;
+    }
+}
+
+int array_sort(Array * array, int (*compare)(void * a, void * b)) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (!compare) {
+        fputs(ARRAY_NULL_COMPARE, stderr);
+        return 1;
+    } else if (array->num_elem < 2) {
+        return 0;
+    }
+
+    SortCtx ctx;
+    ctx.base = array->list;
+    ctx.size = array->elem_size;
+    ctx.compare = compare;
+    ctx.swap = swap_for_size(array->elem_size);
+    ctx.tmp = malloc(array->elem_size);
+    if (!ctx.tmp) {
+        fputs(ARRAY_LIST_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    int log2 = 0;
+    for (size_t n = array->num_elem; n > 1; n >>= 1)
+        log2++;
+
+    pdqsort_loop(&ctx, 0, array->num_elem, log2, 1);
+
+    free(ctx.tmp);
+    return 0;
+}
+
+#undef AT
+#undef LESS
+#undef SWAP
+
+/*
+ * LSD radix sort over an array of precomputed unsigned keys, one byte per
+ * pass. Passes where every key falls in the same bucket are skipped. When
+ * keys points at the array buffer itself the elements are the keys and are
+ * sorted directly; otherwise elements are moved along with their keys.
+ */
+#define RADIX_SORT_DEFINE(NAME, KTYPE)                                          \
+static int NAME(Array * array, KTYPE * keys) {                                  \
+    size_t n = array->num_elem, size = array->elem_size;                        \
+    int inline_keys = (void *) keys == array->list;                             \
+    size_t (*counts)[256] = calloc(sizeof(KTYPE), sizeof(*counts));             \
+    KTYPE * key_buf = malloc(n * sizeof(KTYPE));                                \
+    char * elem_buf = inline_keys ? NULL : malloc(n * size);                    \
+                                                                                \
+    if (!counts || !key_buf || (!inline_keys && !elem_buf)) {                   \
+        fputs(ARRAY_LIST_ALLOCATION_ERROR, stderr);                             \
+        free(counts); free(key_buf); free(elem_buf);                            \
+        return 1;                                                               \
+    }                                                                           \
+                                                                                \
+    for (size_t i = 0; i < n; i++)                                              \
+        for (size_t p = 0; p < sizeof(KTYPE); p++)                              \
+            counts[p][(keys[i] >> (8 * p)) & 0xff]++;                           \
+                                                                                \
+    KTYPE * key_src = keys, * key_dst = key_buf;                                \
+    char * elem_src = array->list, * elem_dst = elem_buf;                       \
+                                                                                \
+    for (size_t p = 0; p < sizeof(KTYPE); p++) {                                \
+        unsigned shift = 8 * p;                                                 \
+        if (counts[p][(key_src[0] >> shift) & 0xff] == n)                       \
+            continue;                                                           \
+                                                                                \
+        size_t offset = 0;                                                      \
+        for (int b = 0; b < 256; b++) {                                         \
+            size_t c = counts[p][b];                                            \
+            counts[p][b] = offset;                                              \
+            offset += c;                                                        \
+        }                                                                       \
+                                                                                \
+        for (size_t i = 0; i < n; i++) {                                        \
+            size_t pos = counts[p][(key_src[i] >> shift) & 0xff]++;             \
+            key_dst[pos] = key_src[i];                                          \
+            if (!inline_keys)                                                   \
+                memcpy(elem_dst + pos * size, elem_src + i * size, size);       \
+        }                                                                       \
+                                                                                \
+        KTYPE * kt = key_src; key_src = key_dst; key_dst = kt;                  \
+        char * et = elem_src; elem_src = elem_dst; elem_dst = et;               \
+    }                                                                           \
+                                                                                \
+    if (inline_keys && key_src != keys)                                         \
+        memcpy(keys, key_src, n * sizeof(KTYPE));                               \
+    else if (!inline_keys && elem_src != array->list)                           \
+        memcpy(array->list, elem_src, n * size);                                \
+                                                                                \
+    free(counts); free(key_buf); free(elem_buf);                                \
+    return 0;                                                                   \
+}
+
+RADIX_SORT_DEFINE(radix_sort_32, uint32_t)
+RADIX_SORT_DEFINE(radix_sort_64, uint64_t)
+
+/* Checks the common preconditions of the radix sorts. Returns 1 when the
+ * sort can't go on, 0 otherwise. */
+static int radix_check(Array * array, int has_key, size_t key_size) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (!has_key && array->elem_size != key_size) {
+        fputs(ARRAY_RADIX_KEY_SIZE, stderr);
+        return 1;
+    }
+    return 0;
+}
+
+int array_sort_u32(Array * array, uint32_t (*key)(void * elem)) {
+    if (radix_check(array, key != NULL, sizeof(uint32_t)))
+        return 1;
+    if (array->num_elem < 2)
+        return 0;
+    if (!key)
+        return radix_sort_32(array, array->list);
+
+    uint32_t * keys = malloc(array->num_elem * sizeof(uint32_t));
+    if (!keys) {
+        fputs(ARRAY_LIST_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    char * elem = array->list;
+    for (int i = 0; i < array->num_elem; i++, elem += array->elem_size)
+        keys[i] = key(elem);
+
+    int ret = radix_sort_32(array, keys);
+    free(keys);
+    return ret;
+}
+
+int array_sort_u64(Array * array, uint64_t (*key)(void * elem)) {
+    if (radix_check(array, key != NULL, sizeof(uint64_t)))
+        return 1;
+    if (array->num_elem < 2)
+        return 0;
+    if (!key)
+        return radix_sort_64(array, array->list);
+
+    uint64_t * keys = malloc(array->num_elem * sizeof(uint64_t));
+    if (!keys) {
+        fputs(ARRAY_LIST_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    char * elem = array->list;
+    for (int i = 0; i < array->num_elem; i++, elem += array->elem_size)
+        keys[i] = key(elem);
+
+    int ret = radix_sort_64(array, keys);
+    free(keys);
+    return ret;
+}
+
+int array_sort_i64(Array * array, int64_t (*key)(void * elem)) {
+    if (radix_check(array, key != NULL, sizeof(int64_t)))
+        return 1;
+    if (array->num_elem < 2)
+        return 0;
+
+    uint64_t * keys = malloc(array->num_elem * sizeof(uint64_t));
+    if (!keys) {
+        fputs(ARRAY_LIST_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    /* Flipping the sign bit makes two's complement order unsigned */
+    char * elem = array->list;
+    for (int i = 0; i < array->num_elem; i++, elem += array->elem_size) {
+        int64_t v;
+        if (key)
+            v = key(elem);
+        else
+            memcpy(&v, elem, sizeof(v));
+        keys[i] = (uint64_t) v ^ ((uint64_t) 1 << 63);
+    }
+
+    int ret = radix_sort_64(array, keys);
+    free(keys);
+    return ret;
+}
+
+int array_sort_float(Array * array, float (*key)(void * elem)) {
+    if (radix_check(array, key != NULL, sizeof(float)))
+        return 1;
+    if (array->num_elem < 2)
+        return 0;
+
+    uint32_t * keys = malloc(array->num_elem * sizeof(uint32_t));
+    if (!keys) {
+        fputs(ARRAY_LIST_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    /* IEEE 754 bits order like sign-magnitude integers: negative values get
+     * all bits flipped, positive ones just the sign bit */
+    char * elem = array->list;
+    for (int i = 0; i < array->num_elem; i++, elem += array->elem_size) {
+        float f;
+        uint32_t bits;
+        if (key)
+            f = key(elem);
+        else
+            memcpy(&f, elem, sizeof(f));
+        memcpy(&bits, &f, sizeof(bits));
+        keys[i] = (bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u;
+    }
+
+    int ret = radix_sort_32(array, keys);
+    free(keys);
+    return ret;
 }
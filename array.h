@@ -2,6 +2,18 @@
 #define ARRAY_H
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bloom.h"
+#include "allocator.h"
+
+/**
+ * @brief Flags telling which parts of an Array were allocated on the heap
+ */
+#define ARRAY_HEAP_HEADER 1     //the Array structure itself, freed by array_terminate
+#define ARRAY_HEAP_LIST 2       //a separate list buffer, freed on growth and by array_terminate
+#define ARRAY_PRIVATE_MAP 4     //list is a copy-on-write file mapping from array_map
+#define ARRAY_MAPPED 8          //list is a file mapping from array_map, which can't be grown
 
 
 /**
@@ -13,23 +25,41 @@ typedef struct Array {
     int total_size;                 //the total length of the array
     size_t elem_size;               //length in bytes of one single element        
     void (*destroy)(void * data);   //funtion pointer for elements cleaning up routine
+    Bloom * filter;                 //optional membership filter checked by array_search, NULL if none
+    int flags;                      //ARRAY_HEAP_* flags of the parts owned by the array
+    const Allocator * allocator;    //allocator of the parts owned by the array
 } Array;
 
+/**
+ * @brief Offset of the inline elements that follow a heap allocated Array
+ */
+#define ARRAY_INLINE_OFFSET \
+    ((sizeof(Array) + _Alignof(max_align_t) - 1) / _Alignof(max_align_t) * _Alignof(max_align_t))
+
 /**
  * @brief Initializes a new Array
  * 
  * It allocates a new array of a specified length given by init_tam parameter.
+ * The structure and the initial elements share a single allocation; the
+ * elements move to a buffer of their own only if the array grows past it.
+ * Hence the array must be released with array_terminate, never by freeing
+ * its list.
  * 
  * @param destroy A pointer to funtion that will be used to clean up
  *                array elements from memory. The prototype of this shloud
  *                be 
  *                      void destroy (void * data);
- *                For example, if you use malloc() from stdlib to allocate data
- *                free() can passed as the destroy funtion.
+ *                data points to the storage of the element inside the array,
+ *                which belongs to the array, so destroy must release only what
+ *                the element refers to and never free data itself. Hence free()
+ *                can't be passed as the destroy function. For example, for an
+ *                array of pointers to memory from malloc(), destroy shall be
+ *                      void destroy (void * data) { free(*(void **) data); }
  * 
  * @param init_size Speciefies a initial length for the array.
  *                 Non positive values (<= 0) will create an
- *                 array of inital length 10
+ *                 array with no room, which gets it on the first
+ *                 insertion
  * 
  * @return A pointer to a new Array type.
  */
@@ -37,18 +67,89 @@ typedef struct Array {
 Array * array_init(void (*destroy)(void * data), int init_size, size_t elem_size);
 
 /**
- * @brief Reallocates an array in memory
+ * @brief Initializes a new Array whose memory comes from an allocator
  * 
- * @param array Pointer to the array to be reallocated
+ * The structure, the initial elements and any later element buffer are
+ * allocated with the given allocator, which must outlive the array.
+ * See array_init.
  * 
- * @param new_size The new length of the reallocated array. If new_len
- *                is lower than the previous len, than a NULL pointer
- *                shall be returned.
+ * @param allocator The allocator. NULL selects the C library one.
+ * 
+ * @return A pointer to a new Array type, or NULL if memory allocation fails.
+ */
+Array * array_init_with(void (*destroy)(void * data), int init_size, size_t elem_size,
+                        const Allocator * allocator);
+
+/**
+ * @brief Initializes an Array over storage given by the caller
+ * 
+ * Neither the structure nor the first capacity elements touch the heap, so
+ * arrays kept on the stack or inside an arena cost no allocation at all.
+ * If the array grows past capacity, its elements spill to a heap buffer that
+ * array_terminate frees; the caller storage is never freed. The heap buffer
+ * comes from the C library allocator, unless another one is set in the
+ * allocator field before the array grows.
+ * 
+ * @param array Structure to be initialized
+ * 
+ * @param storage Room for capacity elements, aligned for the element type.
+ *                May be NULL if capacity is 0.
+ * 
+ * @param capacity Number of elements that fit in storage
  * 
  * @param elem_size The size in bytes of a individual element of the array
  * 
+ * @param destroy See array_init
+ * 
+ * @return array, or NULL if a parameter is invalid.
+ */
+Array * array_init_in_place(Array * array, void * storage, int capacity, size_t elem_size,
+                            void (*destroy)(void * data));
+
+/**
+ * @brief Declares an Array with room for n elements on the stack
+ * 
+ * It declares a pointer named name to an Array whose structure and first n
+ * elements live in the enclosing scope. It spills to the heap only if more
+ * than n elements are inserted, so array_terminate must still be called
+ * before the scope ends.
+ * 
+ *      ARRAY_SMALL(points, Point, 16);
+ *      array_append(points, &p);
+ *      array_terminate(points);
  */
-void array_reallocate(Array * array, int new_size);
+#define ARRAY_SMALL(name, type, n)                                              \
+    type name##_storage[n];                                                     \
+    Array name##_header;                                                        \
+    Array * name = array_init_in_place(&name##_header, name##_storage, (n),     \
+                                       sizeof(type), NULL)
+
+/**
+ * @brief Destroys the array
+ * 
+ * It calls destroy, if any, on a pointer to each element, and frees the
+ * array along with its filter. Only the parts allocated on the heap are
+ * freed, so it works the same for arrays from array_init and from
+ * array_init_in_place. Arrays from array_map are unmapped.
+ * 
+ * @param array Pointer to the array to be destroyed
+ */
+void array_terminate(Array * array);
+
+/**
+ * @brief Reallocates an array in memory
+ * 
+ * @param array Pointer to the array to be reallocated
+ * 
+ * @param new_size The new length of the reallocated array. If new_size
+ *                is not greater than the current length, the array is
+ *                left as it is.
+ * 
+ * @return 0 if the array has room for new_size elements, 1 otherwise. The
+ *         array is unchanged on failure. Arrays from array_map can't grow, so
+ *         they always fail here, and so do the insertions that need room.
+ */
+int array_reallocate(Array * array, int new_size);
 
 
 /**
@@ -73,15 +174,40 @@ int array_insert_at(Array * array, int index, void * data);
  * 
  * @param data a pointer the data to be appendeded 
  * 
+ * @return 0 if the element was appended, 1 otherwise. The array is unchanged
+ *         on failure.
+ */
+int array_append(Array * array, void * data);
+
+/**
+ * @brief Appends several elements at the end of the array
+ * 
+ * It does the same as calling array_append for each element, but the array
+ * grows at most once and the elements are copied in a single pass.
+ * 
+ * @param array The array where the elements will be appended
+ * 
+ * @param data Pointer to n contiguous elements of elem_size bytes each
+ * 
+ * @param n The number of elements to append
+ * 
+ * @return 0 if the elements were appended, 1 otherwise. The array is unchanged
+ *         on failure.
+ */
+int array_append_n(Array * array, const void * data, int n);
+
+/**
+ * @brief Returned by array_sorted_insert when the element could not be inserted
  */
-void array_append(Array * array, void * data);
+#define ARRAY_INSERT_FAILED (-2)
 
 /**
  * @brief Inserts a new element so that the array is kept sorted
  * 
  * Supposing a sorted array, this function makes an insertion so that the array continues sorted.
- * It will do a sequential search comparing each element until find some so that it has data key
- * greater than the to be inserted one, then inserts in before. If an element with the same data
+ * It does a binary search for the first element whose data key is not lower than the one to be
+ * inserted, so it takes O(log n) comparisons, and inserts the new one before it, shifting the
+ * following elements. If an element with the same data
  * key is found, then the function will return the index where this element is, so the user 
  * can decide if will insert this element or not. If so, then the user can use the array_inser_at
  * function. The comprison function used in search is user defined, and for more details of
@@ -95,7 +221,9 @@ void array_append(Array * array, void * data);
  *                more details.
  * 
  * @return If the array contains a previous element with the same data key, then it
- *         will return the index of this element. If not, it shall return -1. 
+ *         will return the index of this element. If not, it shall return -1 once the
+ *         element is inserted, or ARRAY_INSERT_FAILED if the insertion failed, in
+ *         which case the array is unchanged.
  */
 int array_sorted_insert(Array * array, void * data, int (*compare)(void*a, void*b));
 
@@ -145,6 +273,90 @@ int array_remove_last(Array * array);
  */
 void * array_search(Array * array, void * x, int (*compare)(void*a, void*b));
 
+/**
+ * @brief Sorts the array in place using a user defined comparison function
+ * 
+ * It uses pattern-defeating quicksort: a quicksort with a pseudomedian pivot
+ * that falls back to heap sort on bad inputs, so it is O(n log n) in the worst
+ * case and linear on already sorted inputs. Elements are swapped
+ * with routines specialized for 4, 8 and 16 bytes element sizes.
+ * The sort is not stable.
+ * 
+ * @param array A pointer to the array to be sorted
+ * 
+ * @param compare A comparison function analogue to strcmp() from string.h.
+ *                See array_search for more details.
+ * 
+ * @return 0 if the array was sorted, 1 otherwise.
+ */
+int array_sort(Array * array, int (*compare)(void*a, void*b));
+
+/**
+ * @brief Sorts the array by an unsigned 32 bits key using LSD radix sort
+ * 
+ * The key of each element is given by a key extractor function, which prototype
+ * shall be
+ * 
+ *      uint32_t key(void * elem);
+ * 
+ * Keys are extracted once, so the extractor is called num_elem times. If key is
+ * NULL, the elements themselves are taken as the keys, which requires elem_size
+ * to be 4. The sort is stable and needs num_elem * (elem_size + key size) bytes
+ * of scratch memory.
+ * 
+ * @param array A pointer to the array to be sorted
+ * 
+ * @param key A key extractor function or NULL
+ * 
+ * @return 0 if the array was sorted, 1 otherwise.
+ */
+int array_sort_u32(Array * array, uint32_t (*key)(void * elem));
+
+/**
+ * @brief Same as array_sort_u32, but for unsigned 64 bits keys
+ */
+int array_sort_u64(Array * array, uint64_t (*key)(void * elem));
+
+/**
+ * @brief Same as array_sort_u32, but for signed 64 bits keys
+ */
+int array_sort_i64(Array * array, int64_t (*key)(void * elem));
+
+/**
+ * @brief Same as array_sort_u32, but for float keys
+ * 
+ * Negative values come before positive ones and -0.0 comes before 0.0.
+ * NaNs with the sign bit set go first and the remaining ones go last.
+ */
+int array_sort_float(Array * array, float (*key)(void * elem));
+
+/**
+ * @brief Attaches a membership filter to the array
+ * 
+ * Once attached, array_search first asks the filter and returns NULL right away
+ * for most of the elements that are not in the array, without scanning it.
+ * The filter learns every inserted element. Removals make it stale, and it's
+ * rebuilt by the next search, as it is when the array outgrows it.
+ * 
+ * @param array Pointer to the array
+ * 
+ * @param hash Hash function, called with a pointer to an element. Elements equal
+ *             for the compare function given to array_search must have the same hash.
+ * 
+ * @param fp_rate Target false positive rate, that is, the share of misses still
+ *                scanning the array. See bloom_init.
+ * 
+ * @param max_bytes Memory budget of the filter, 0 for no limit
+ * 
+ * @return 0 on success, 1 otherwise. A filter already attached is replaced.
+ */
+int array_attach_filter(Array * array, uint64_t (*hash)(void * elem), double fp_rate, size_t max_bytes);
+
+/**
+ * @brief Detaches and destroys the membership filter of the array, if any
+ */
+void array_detach_filter(Array * array);
+
 void array_remove_duplicates(Array * array, int (*compare)(void*a, void*b ));
 
 void * array_quickselect(Array * array, int n);
@@ -0,0 +1,192 @@
+#include "array_index.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ARRAY_NULL_POINTER "Array pointer parameter is NULL\n"
+
+#define INDEX_NULL_POINTER "Search index pointer parameter is NULL\n"
+
+#define NULL_KEY_POINTER "Key pointer parameter is NULL\n"
+
+#define KEY_TYPE_SIZE_MISMATCH "Array elem_size does not match the key type size\n"
+
+#define ARRAY_NOT_SORTED "Array is not sorted or holds NaNs\n"
+
+#define INDEX_ALLOCATION_ERROR "Memory allocation error for the search index\n"
+
+#define CACHE_LINE 64
+
+/* Keys per cache line, so a node's descendants three levels down share one */
+#define KEYS_PER_LINE (CACHE_LINE / sizeof(uint64_t))
+
+#define SIGN_BIT (1ULL << 63)
+
+static size_t key_size(ArrayKeyType type) {
+    switch (type) {
+        case ARRAY_KEY_I8: case ARRAY_KEY_U8: return 1;
+        case ARRAY_KEY_I16: case ARRAY_KEY_U16: return 2;
+        case ARRAY_KEY_I32: case ARRAY_KEY_U32: case ARRAY_KEY_FLOAT: return 4;
+        case ARRAY_KEY_I64: case ARRAY_KEY_U64: case ARRAY_KEY_DOUBLE: return 8;
+    }
+    return 0;
+}
+
+/* Order preserving encoding of a double: positives get the sign bit set, and
+ * negatives get all bits flipped so larger magnitudes come first */
+static int encode_double(double value, uint64_t * out) {
+    if (value != value)
+        return 1;
+    if (value == 0)
+        value = 0;          /* -0.0 sorts with 0.0 */
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    *out = bits & SIGN_BIT ? ~bits : bits | SIGN_BIT;
+    return 0;
+}
+
+/* Encodes the value at p as an unsigned key with the same order. Returns 1
+ * for NaNs, which have no place in the order. */
+static int encode(ArrayKeyType type, const void * p, uint64_t * out) {
+    switch (type) {
+        case ARRAY_KEY_I8:  { int8_t v;   memcpy(&v, p, 1); *out = (uint64_t) (int64_t) v ^ SIGN_BIT; return 0; }
+        case ARRAY_KEY_U8:  { uint8_t v;  memcpy(&v, p, 1); *out = v; return 0; }
+        case ARRAY_KEY_I16: { int16_t v;  memcpy(&v, p, 2); *out = (uint64_t) (int64_t) v ^ SIGN_BIT; return 0; }
+        case ARRAY_KEY_U16: { uint16_t v; memcpy(&v, p, 2); *out = v; return 0; }
+        case ARRAY_KEY_I32: { int32_t v;  memcpy(&v, p, 4); *out = (uint64_t) (int64_t) v ^ SIGN_BIT; return 0; }
+        case ARRAY_KEY_U32: { uint32_t v; memcpy(&v, p, 4); *out = v; return 0; }
+        case ARRAY_KEY_I64: { int64_t v;  memcpy(&v, p, 8); *out = (uint64_t) v ^ SIGN_BIT; return 0; }
+        case ARRAY_KEY_U64: { memcpy(out, p, 8); return 0; }
+        case ARRAY_KEY_FLOAT: { float v;  memcpy(&v, p, 4); return encode_double(v, out); }
+        case ARRAY_KEY_DOUBLE: { double v; memcpy(&v, p, 8); return encode_double(v, out); }
+    }
+    return 1;
+}
+
+/* Lays the sorted keys out in Eytzinger order: an in-order walk of the
+ * implicit tree visits the positions in sorted order */
+static int eytzinger_fill(ArraySearchIndex * index, const uint64_t * sorted, int i, size_t k) {
+    if (k <= (size_t) index->num_elem) {
+        i = eytzinger_fill(index, sorted, i, 2 * k);
+        index->keys[k] = sorted[i];
+        index->rank[k] = i;
+        i = eytzinger_fill(index, sorted, i + 1, 2 * k + 1);
+    }
+    return i;
+}
+
+ArraySearchIndex * array_freeze_search_index(Array * array, ArrayKeyType type) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return NULL;
+    } else if (key_size(type) != array->elem_size) {
+        fputs(KEY_TYPE_SIZE_MISMATCH, stderr);
+        return NULL;
+    }
+
+    int n = array->num_elem;
+    size_t keys_bytes = ((size_t) n + 1) * sizeof(uint64_t);
+    keys_bytes = (keys_bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+
+    ArraySearchIndex * index = malloc(sizeof(ArraySearchIndex));
+    uint64_t * sorted = malloc(((size_t) n + 1) * sizeof(uint64_t));
+    if (index) {
+        index->keys = aligned_alloc(CACHE_LINE, keys_bytes);
+        index->rank = malloc(((size_t) n + 1) * sizeof(int));
+    }
+
+    if (!index || !sorted || !index->keys || !index->rank) {
+        fputs(INDEX_ALLOCATION_ERROR, stderr);
+        if (index) {
+            free(index->keys);
+            free(index->rank);
+        }
+        free(index);
+        free(sorted);
+        return NULL;
+    }
+
+    const char * elem = array->list;
+    int failed = 0;
+
+    for (int i = 0; i < n && !failed; i++, elem += array->elem_size)
+        failed = encode(type, elem, &sorted[i]) || (i > 0 && sorted[i] < sorted[i - 1]);
+
+    if (failed) {
+        fputs(ARRAY_NOT_SORTED, stderr);
+        free(sorted);
+        array_search_index_terminate(index);
+        return NULL;
+    }
+
+    index->num_elem = n;
+    index->type = type;
+    index->keys[0] = 0;
+    index->rank[0] = n;
+    eytzinger_fill(index, sorted, 0, 1);
+
+    free(sorted);
+    return index;
+}
+
+void array_search_index_terminate(ArraySearchIndex * index) {
+    if (!index) {
+        fputs(INDEX_NULL_POINTER, stderr);
+        return;
+    }
+
+    free(index->keys);
+    free(index->rank);
+    free(index);
+}
+
+/* Position of the first key not less than x, 0 if there is none */
+static size_t eytzinger_lower_bound(const ArraySearchIndex * index, uint64_t x) {
+    const uint64_t * keys = index->keys;
+    size_t n = (size_t) index->num_elem;
+    size_t k = 1;
+
+    while (k <= n) {
+        /* Address arithmetic, since the line may be past the end of keys */
+        __builtin_prefetch((const void *) ((uintptr_t) keys + k * KEYS_PER_LINE * sizeof(uint64_t)), 0, 1);
+        k = 2 * k + (keys[k] < x);
+    }
+
+    /* Every right turn was taken past a smaller key: drop the trailing ones
+     * and the left turn before them to get back to the answer */
+    k >>= __builtin_ffsll((long long) ~k);
+    return k;
+}
+
+int array_index_lower_bound(const ArraySearchIndex * index, void * key) {
+    if (!index) {
+        fputs(INDEX_NULL_POINTER, stderr);
+        return -1;
+    } else if (!key) {
+        fputs(NULL_KEY_POINTER, stderr);
+        return -1;
+    }
+
+    uint64_t x;
+    if (encode(index->type, key, &x))
+        return -1;
+
+    return index->rank[eytzinger_lower_bound(index, x)];
+}
+
+int array_index_find(const ArraySearchIndex * index, void * key) {
+    if (!index) {
+        fputs(INDEX_NULL_POINTER, stderr);
+        return -1;
+    } else if (!key) {
+        fputs(NULL_KEY_POINTER, stderr);
+        return -1;
+    }
+
+    uint64_t x;
+    if (encode(index->type, key, &x))
+        return -1;
+
+    size_t k = eytzinger_lower_bound(index, x);
+    return k != 0 && index->keys[k] == x ? index->rank[k] : -1;
+}
@@ -0,0 +1,89 @@
+#ifndef ARRAY_INDEX_H
+#define ARRAY_INDEX_H
+
+#include <stdint.h>
+#include "array.h"
+#include "array_scan.h"
+
+/**
+ * @file array_index.h
+ * @brief Cache friendly search index for read-only sorted arrays.
+ *
+ * Binary search over a large sorted array misses the cache on almost every
+ * probe: the first few probes always hit the same elements, but each later
+ * one lands far from the previous and touches a new cache line.
+ *
+ * The search index stores the keys of a sorted array of primitive elements in
+ * Eytzinger order, the breadth first order of the implicit binary search tree:
+ * the root at position 1 and the children of position k at 2k and 2k + 1. The
+ * top levels of the tree share a few cache lines that stay hot, and the eight
+ * great-grandchildren of a node share a single line, which the search
+ * prefetches three levels ahead. The loop has no unpredictable branch: each
+ * step picks the child with arithmetic on the comparison result.
+ *
+ * Keys are stored as 64 bits unsigned integers whose order matches the order
+ * of the original type, so a single search loop serves all key types. Results
+ * are indices into the original array.
+ *
+ * The index is a snapshot: changes to the array after it was built are not
+ * seen by the index. It takes 12 bytes per element.
+ */
+
+/**
+ * @brief The search index structure
+ */
+typedef struct ArraySearchIndex {
+    uint64_t * keys;                //encoded keys in Eytzinger order from position 1, cache line aligned
+    int * rank;                     //index in the array of the key at each position
+    int num_elem;                   //number of keys
+    ArrayKeyType type;              //type of the array elements
+} ArraySearchIndex;
+
+/**
+ * @brief Builds the search index of a sorted array
+ *
+ * The array must hold elements of the given primitive type sorted in
+ * ascending order. Floating point arrays may not hold NaNs; -0.0 and 0.0 are
+ * considered equal.
+ *
+ * @param array Pointer to the sorted array
+ *
+ * @param type The type of the array elements
+ *
+ * @return A pointer to the new index, or NULL if the array is not sorted, its
+ *         elem_size doesn't match the type or memory allocation fails.
+ */
+ArraySearchIndex * array_freeze_search_index(Array * array, ArrayKeyType type);
+
+/**
+ * @brief Destroys the index, leaving the array untouched
+ */
+void array_search_index_terminate(ArraySearchIndex * index);
+
+/**
+ * @brief Finds the first element not less than key
+ *
+ * @param index Pointer to the index
+ *
+ * @param key Pointer to a value of the index type
+ *
+ * @return The array index of the first element greater than or equal to key,
+ *         num_elem if every element is smaller, or -1 if the parameters are
+ *         invalid or key is a NaN.
+ */
+int array_index_lower_bound(const ArraySearchIndex * index, void * key);
+
+/**
+ * @brief Finds the first element equal to key
+ *
+ * @return The array index of the first match, or -1 if there is none or the
+ *         parameters are invalid.
+ */
+int array_index_find(const ArraySearchIndex * index, void * key);
+
+/**
+ * @brief Number of keys in the index
+ */
+#define array_search_index_num_elem(index) ((index)->num_elem)
+
+#endif
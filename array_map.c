@@ -0,0 +1,297 @@
+#define _DEFAULT_SOURCE
+#include "array_map.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define ARRAY_NULL_POINTER "Array pointer parameter is NULL"
+
+#define ARRAY_ALLOCATION_ERROR "Memory allocation error for the array"
+
+#define ARRAY_FILE_OPEN_ERROR "Could not open the array file\n"
+
+#define ARRAY_FILE_WRITE_ERROR "Could not write the array file\n"
+
+#define ARRAY_FILE_MAP_ERROR "Could not map the array file\n"
+
+#define ARRAY_FILE_FORMAT_ERROR "File is not a valid array file\n"
+
+#define ARRAY_FILE_CHECKSUM_ERROR "Array file checksum mismatch\n"
+
+#define ARRAY_NOT_MAPPED "Array was not returned by array_map\n"
+
+#define ARRAY_ADVICE_ERROR "Pages of a private mapping can't be dropped without losing its changes\n"
+
+#define ARRAY_FILE_MAGIC "DSAARRAY"
+
+#define ARRAY_FILE_VERSION 1
+
+/*
+ * On disk header. It takes 64 bytes so the data that follows is aligned to a
+ * cache line, and to any element type, once the file is mapped.
+ */
+typedef struct ArrayFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t elem_size;
+    uint64_t num_elem;
+    uint64_t checksum;
+    char reserved[24];
+} ArrayFileHeader;
+
+/*
+ * A mapped array along with its mapping. The allocator releases the mapping
+ * when array_terminate frees the header, so both ways of releasing the array
+ * unmap it.
+ */
+typedef struct MappedArray {
+    Array array;                    /* first, so the Array pointer is the MappedArray one */
+    Allocator allocator;
+    void * base;                    /* start of the mapping, at the file header */
+    size_t length;
+} MappedArray;
+
+/* 64 bits multiply-xor hash over whole words, so checking a big file runs at
+ * memory speed rather than byte by byte */
+static uint64_t checksum(const void * data, size_t len) {
+    const unsigned char * p = data;
+    uint64_t h = 0xcbf29ce484222325ULL ^ len;
+
+    for (; len >= 8; len -= 8, p += 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 0x100000001b3ULL;
+        h ^= h >> 29;
+    }
+    for (; len > 0; len--, p++)
+        h = (h ^ *p) * 0x100000001b3ULL;
+
+    return h ^ (h >> 32);
+}
+
+/* Creates a new file next to path, to be renamed over it once complete. Its
+ * name is written to tmp_path, which has room for strlen(path) + 32 bytes. */
+static int create_temporary(const char * path, char * tmp_path) {
+    static atomic_uint counter;
+
+    for (int attempt = 0; attempt < 16; attempt++) {
+        sprintf(tmp_path, "%s.tmp.%ld.%u", path, (long) getpid(), atomic_fetch_add(&counter, 1));
+
+        int fd = open(tmp_path, O_WRONLY | O_CREAT | O_EXCL, 0666);
+        if (fd >= 0 || errno != EEXIST)
+            return fd;
+    }
+    return -1;
+}
+
+/* Flushes the directory holding path, so a rename into it survives a crash */
+static void sync_parent(const char * path, char * dir_path) {
+    const char * slash = strrchr(path, '/');
+
+    if (!slash)
+        strcpy(dir_path, ".");
+    else if (slash == path)
+        strcpy(dir_path, "/");
+    else {
+        memcpy(dir_path, path, slash - path);
+        dir_path[slash - path] = '\0';
+    }
+
+    int fd = open(dir_path, O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+int array_save(Array * array, const char * path) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    }
+
+    /* The array goes to a temporary file that replaces the target only once
+     * it's complete and on disk, so a crash midway leaves the previous file */
+    char * tmp_path = malloc(strlen(path) + 32);
+    if (!tmp_path) {
+        fputs(ARRAY_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    int fd = create_temporary(path, tmp_path);
+    FILE * file = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (!file) {
+        fputs(ARRAY_FILE_OPEN_ERROR, stderr);
+        if (fd >= 0) {
+            close(fd);
+            unlink(tmp_path);
+        }
+        free(tmp_path);
+        return 1;
+    }
+
+    size_t data_len = (size_t) array->num_elem * array->elem_size;
+
+    ArrayFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARRAY_FILE_MAGIC, sizeof(header.magic));
+    header.version = ARRAY_FILE_VERSION;
+    header.header_size = sizeof(header);
+    header.elem_size = array->elem_size;
+    header.num_elem = array->num_elem;
+    header.checksum = checksum(array->list, data_len);
+
+    int failed = fwrite(&header, sizeof(header), 1, file) != 1
+              || (data_len && fwrite(array->list, data_len, 1, file) != 1)
+              || fflush(file) != 0
+              || fsync(fd) != 0;
+
+    if (fclose(file) != 0)
+        failed = 1;
+
+    if (!failed)
+        failed = rename(tmp_path, path) != 0;
+
+    if (failed) {
+        fputs(ARRAY_FILE_WRITE_ERROR, stderr);
+        unlink(tmp_path);
+        free(tmp_path);
+        return 1;
+    }
+
+    /* tmp_path has room for the directory name too. The data is safe by now,
+     * only the durability of the rename depends on this. */
+    sync_parent(path, tmp_path);
+    free(tmp_path);
+    return 0;
+}
+
+/* Frees a mapped array header, which is the last part array_terminate
+ * releases, along with its mapping */
+static void release_mapping(void * ptr, void * ctx) {
+    MappedArray * mapped = ctx;
+
+    (void) ptr;
+    munmap(mapped->base, mapped->length);
+    free(mapped);
+}
+
+Array * array_map(const char * path, int flags) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fputs(ARRAY_FILE_OPEN_ERROR, stderr);
+        return NULL;
+    }
+
+    struct stat st;
+    ArrayFileHeader header;
+
+    if (fstat(fd, &st) != 0
+        || (size_t) st.st_size < sizeof(header)
+        || pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)
+        || memcmp(header.magic, ARRAY_FILE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != ARRAY_FILE_VERSION
+        || header.header_size != sizeof(header)
+        || header.elem_size == 0
+        || header.num_elem > (uint64_t) INT32_MAX
+        /* Divided rather than multiplied, so a forged elem_size can't wrap */
+        || (header.num_elem > 0
+            && header.elem_size > ((uint64_t) st.st_size - sizeof(header)) / header.num_elem)) {
+        fputs(ARRAY_FILE_FORMAT_ERROR, stderr);
+        close(fd);
+        return NULL;
+    }
+
+    size_t data_len = header.num_elem * header.elem_size;
+    size_t length = sizeof(header) + data_len;
+
+    int prot = PROT_READ, share = MAP_SHARED;
+    if (flags & ARRAY_MAP_PRIVATE) {
+        prot |= PROT_WRITE;
+        share = MAP_PRIVATE;
+    }
+
+    char * base = mmap(NULL, length, prot, share, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        fputs(ARRAY_FILE_MAP_ERROR, stderr);
+        return NULL;
+    }
+
+    if ((flags & ARRAY_MAP_VERIFY) && checksum(base + sizeof(header), data_len) != header.checksum) {
+        fputs(ARRAY_FILE_CHECKSUM_ERROR, stderr);
+        munmap(base, length);
+        return NULL;
+    }
+
+    MappedArray * mapped = malloc(sizeof(MappedArray));
+    if (!mapped) {
+        fputs(ARRAY_ALLOCATION_ERROR, stderr);
+        munmap(base, length);
+        return NULL;
+    }
+
+    mapped->allocator = allocator_libc;
+    mapped->allocator.free = release_mapping;
+    mapped->allocator.ctx = mapped;
+    mapped->base = base;
+    mapped->length = length;
+
+    Array * array = &mapped->array;
+    array->list = base + sizeof(header);
+    array->num_elem = array->total_size = (int) header.num_elem;
+    array->elem_size = header.elem_size;
+    array->destroy = NULL;
+    array->filter = NULL;
+    array->flags = ARRAY_HEAP_HEADER | ARRAY_MAPPED | (flags & ARRAY_MAP_PRIVATE ? ARRAY_PRIVATE_MAP : 0);
+    array->allocator = &mapped->allocator;
+
+    return array;
+}
+
+void array_unmap(Array * array) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return;
+    } else if (!(array->flags & ARRAY_MAPPED)) {
+        fputs(ARRAY_NOT_MAPPED, stderr);
+        return;
+    }
+
+    array_terminate(array);
+}
+
+int array_advise(Array * array, ArrayAdvice advice) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (!(array->flags & ARRAY_MAPPED)) {
+        fputs(ARRAY_NOT_MAPPED, stderr);
+        return 1;
+    } else if (advice == ARRAY_ADVICE_DONTNEED && (array->flags & ARRAY_PRIVATE_MAP)) {
+        /* The dropped pages would come back from the file, without the
+         * changes made to the copy */
+        fputs(ARRAY_ADVICE_ERROR, stderr);
+        return 1;
+    }
+
+    int hint;
+    switch (advice) {
+        case ARRAY_ADVICE_SEQUENTIAL: hint = MADV_SEQUENTIAL; break;
+        case ARRAY_ADVICE_RANDOM:     hint = MADV_RANDOM; break;
+        case ARRAY_ADVICE_WILLNEED:   hint = MADV_WILLNEED; break;
+        case ARRAY_ADVICE_DONTNEED:   hint = MADV_DONTNEED; break;
+        default:                      hint = MADV_NORMAL; break;
+    }
+
+    MappedArray * mapped = (MappedArray *) array;
+    return madvise(mapped->base, mapped->length, hint) != 0;
+}
@@ -0,0 +1,96 @@
+#ifndef ARRAY_MAP_H
+#define ARRAY_MAP_H
+
+#include "array.h"
+
+/**
+ * @file array_map.h
+ * @brief Saving arrays to files and mapping them back into memory.
+ *
+ * An array file starts with a small versioned header (element size, number
+ * of elements and a checksum of the data) followed by the raw list buffer.
+ * Mapping a file with array_map does not read it: pages are loaded by the
+ * operating system as they are touched, so even huge arrays are ready to use
+ * right away.
+ *
+ * Only plain data can be saved this way. Elements holding pointers are saved
+ * as they are and will be meaningless once loaded by another process.
+ */
+
+/**
+ * @brief Flags for array_map
+ */
+enum {
+    ARRAY_MAP_READONLY = 0,     /**< Shared read only mapping. Writing to it crashes. */
+    ARRAY_MAP_PRIVATE = 1,      /**< Copy-on-write mapping. Changes are not written back to the file. */
+    ARRAY_MAP_VERIFY = 2        /**< Checks the data checksum, which reads the whole file. */
+};
+
+/**
+ * @brief Access pattern hints for mapped arrays
+ */
+typedef enum ArrayAdvice {
+    ARRAY_ADVICE_NORMAL,        /**< No special treatment */
+    ARRAY_ADVICE_SEQUENTIAL,    /**< Pages will be read in order, so read ahead aggressively */
+    ARRAY_ADVICE_RANDOM,        /**< Pages will be read in random order, so don't read ahead */
+    ARRAY_ADVICE_WILLNEED,      /**< The whole array will be needed soon, so start loading it */
+    ARRAY_ADVICE_DONTNEED       /**< The array won't be needed soon, so its pages may be dropped. Rejected for ARRAY_MAP_PRIVATE mappings. */
+} ArrayAdvice;
+
+/**
+ * @brief Saves an array to a file
+ *
+ * The array is written to a temporary file in the same directory, flushed to
+ * disk and then renamed over path, so a crash never leaves a partly written
+ * file behind: path holds either the previous contents or the new ones. Only
+ * the num_elem first elements are saved.
+ *
+ * @param array Pointer to the array to be saved
+ *
+ * @param path Path to the file
+ *
+ * @return 0 if the array was saved, 1 otherwise.
+ */
+int array_save(Array * array, const char * path);
+
+/**
+ * @brief Maps an array file saved by array_save into memory
+ *
+ * The returned array has total_size equal to num_elem and a NULL destroy
+ * function. Its list points straight into the mapping, so it can't be
+ * reallocated: array_reallocate and the insertions needing room fail on it.
+ * It is released with array_unmap, or array_terminate, which does the same.
+ *
+ * @param path Path to the file
+ *
+ * @param flags ARRAY_MAP_READONLY or ARRAY_MAP_PRIVATE, optionally or'ed
+ *              with ARRAY_MAP_VERIFY.
+ *
+ * @return A pointer to the mapped array, or NULL if the file can't be mapped,
+ *         is not an array file or fails the checksum verification.
+ */
+Array * array_map(const char * path, int flags);
+
+/**
+ * @brief Unmaps an array returned by array_map
+ *
+ * Arrays that don't come from array_map are refused and left as they are.
+ *
+ * @param array Pointer to the mapped array
+ */
+void array_unmap(Array * array);
+
+/**
+ * @brief Tells the operating system how a mapped array will be accessed
+ *
+ * @param array Pointer to an array returned by array_map
+ *
+ * @param advice The expected access pattern
+ *
+ * @return 0 if the hint was given, 1 otherwise. ARRAY_ADVICE_DONTNEED is
+ *         refused for ARRAY_MAP_PRIVATE mappings, since dropping their pages
+ *         would silently throw away the changes made to them.
+ */
+int array_advise(Array * array, ArrayAdvice advice);
+
+#endif
@@ -0,0 +1,427 @@
+#include "array_parallel.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+
+#define ARRAY_NULL_POINTER "Array pointer parameter is NULL"
+
+#define SCHEDULER_NULL_POINTER "Scheduler pointer parameter is NULL"
+
+#define NULL_FUNCTION_POINTER "Function pointer parameter is NULL"
+
+#define PARALLEL_ALLOCATION_ERROR "Memory allocation error for parallel array work"
+
+#define CACHE_LINE 64
+
+/* Chunks per worker, so uneven chunks still balance out */
+#define CHUNKS_PER_WORKER 4
+
+/* Fewest elements worth a task of their own */
+#define MIN_CHUNK_ELEMS 4096
+
+/* Elements scanned between checks for an earlier match */
+#define SEARCH_CANCEL_STRIDE 1024
+
+/* ---------------------------------------------------------------------------
+ * Chunking
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Splits [0, n) in chunks whose boundaries sit on cache lines. Boundaries are
+ * kept to indices phase + k * granule, where granule is the fewest elements
+ * spanning whole cache lines and phase is the first of them to start a line.
+ */
+typedef struct Chunking {
+    int num_chunks;
+    int chunk_len;      /* multiple of the granule */
+    int phase;
+    int n;
+} Chunking;
+
+static size_t gcd(size_t a, size_t b) {
+    while (b) {
+        size_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static Chunking make_chunking(Scheduler * sched, Array * array) {
+    Chunking c;
+    size_t size = array->elem_size;
+    int granule = (int) (CACHE_LINE / gcd(CACHE_LINE, size));
+    uintptr_t base = (uintptr_t) array->list;
+
+    c.n = array->num_elem;
+    c.phase = 0;
+    for (int p = 0; p < granule && p < c.n; p++) {
+        if ((base + p * size) % CACHE_LINE == 0) {
+            c.phase = p;
+            break;
+        }
+    }
+
+    int wanted = scheduler_num_workers(sched) * CHUNKS_PER_WORKER;
+    int len = c.n / (wanted > 0 ? wanted : 1);
+    if (len < MIN_CHUNK_ELEMS)
+        len = MIN_CHUNK_ELEMS;
+    len = (len + granule - 1) / granule * granule;
+
+    c.chunk_len = len;
+    c.num_chunks = c.n <= c.phase ? 1 : 1 + (c.n - c.phase - 1) / len;
+    return c;
+}
+
+/* First index of chunk k, with chunk num_chunks ending at n */
+static int chunk_start(const Chunking * c, int k) {
+    if (k == 0)
+        return 0;
+    if (k >= c->num_chunks)
+        return c->n;
+    long start = (long) c->phase + (long) k * c->chunk_len;
+    return start < c->n ? (int) start : c->n;
+}
+
+static int check_args(Scheduler * sched, Array * array, const void * fn) {
+    if (!sched) {
+        fputs(SCHEDULER_NULL_POINTER, stderr);
+        return 1;
+    } else if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (!fn) {
+        fputs(NULL_FUNCTION_POINTER, stderr);
+        return 1;
+    }
+    return 0;
+}
+
+/* Runs job on each of the count arguments stored in args, in parallel */
+static void run_jobs(Scheduler * sched, int count, void (*job)(void * arg), void * args, size_t arg_size) {
+    TaskGroup group;
+
+    task_group_init(&group);
+    for (int i = 0; i < count; i++) {
+        void * arg = (char *) args + (size_t) i * arg_size;
+        if (count == 1 || scheduler_spawn(sched, &group, job, arg))
+            job(arg);       /* run inline when spawning isn't worth it or fails */
+    }
+    scheduler_wait(sched, &group);
+}
+
+/* ---------------------------------------------------------------------------
+ * For each
+ * ------------------------------------------------------------------------- */
+
+typedef struct ForEachJob {
+    Array * array;
+    int begin, end;
+    void (*fn)(void * elem, void * ctx);
+    void * ctx;
+} ForEachJob;
+
+static void for_each_job(void * arg) {
+    ForEachJob * job = arg;
+    char * elem = (char *) job->array->list + (size_t) job->begin * job->array->elem_size;
+
+    for (int i = job->begin; i < job->end; i++, elem += job->array->elem_size)
+        job->fn(elem, job->ctx);
+}
+
+int array_parallel_for_each(Scheduler * sched, Array * array, void (*fn)(void * elem, void * ctx), void * ctx) {
+    if (check_args(sched, array, (const void *) fn))
+        return 1;
+
+    Chunking c = make_chunking(sched, array);
+    ForEachJob * jobs = malloc(c.num_chunks * sizeof(ForEachJob));
+    if (!jobs) {
+        fputs(PARALLEL_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    for (int k = 0; k < c.num_chunks; k++) {
+        jobs[k].array = array;
+        jobs[k].begin = chunk_start(&c, k);
+        jobs[k].end = chunk_start(&c, k + 1);
+        jobs[k].fn = fn;
+        jobs[k].ctx = ctx;
+    }
+
+    run_jobs(sched, c.num_chunks, for_each_job, jobs, sizeof(ForEachJob));
+    free(jobs);
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * Search
+ * ------------------------------------------------------------------------- */
+
+typedef struct SearchJob {
+    Array * array;
+    int begin, end;
+    void * x;
+    int (*compare)(void * a, void * b);
+    atomic_int * first;     /* lowest match found so far, INT_MAX if none */
+} SearchJob;
+
+static void search_job(void * arg) {
+    SearchJob * job = arg;
+    size_t size = job->array->elem_size;
+    char * elem = (char *) job->array->list + (size_t) job->begin * size;
+
+    for (int i = job->begin; i < job->end; i++, elem += size) {
+        /* A match in an earlier chunk makes the rest of this one useless */
+        if ((i - job->begin) % SEARCH_CANCEL_STRIDE == 0
+            && atomic_load_explicit(job->first, memory_order_relaxed) < job->begin)
+            return;
+
+        if (job->compare(elem, job->x) == 0) {
+            int seen = atomic_load_explicit(job->first, memory_order_relaxed);
+            while (i < seen && !atomic_compare_exchange_weak(job->first, &seen, i));
+            return;
+        }
+    }
+}
+
+int array_parallel_search(Scheduler * sched, Array * array, void * x, int (*compare)(void * a, void * b)) {
+    if (check_args(sched, array, (const void *) compare))
+        return -1;
+
+    Chunking c = make_chunking(sched, array);
+    SearchJob * jobs = malloc(c.num_chunks * sizeof(SearchJob));
+    if (!jobs) {
+        fputs(PARALLEL_ALLOCATION_ERROR, stderr);
+        return -1;
+    }
+
+    atomic_int first;
+    atomic_init(&first, INT_MAX);
+
+    for (int k = 0; k < c.num_chunks; k++) {
+        jobs[k].array = array;
+        jobs[k].begin = chunk_start(&c, k);
+        jobs[k].end = chunk_start(&c, k + 1);
+        jobs[k].x = x;
+        jobs[k].compare = compare;
+        jobs[k].first = &first;
+    }
+
+    run_jobs(sched, c.num_chunks, search_job, jobs, sizeof(SearchJob));
+    free(jobs);
+
+    int found = atomic_load(&first);
+    return found == INT_MAX ? -1 : found;
+}
+
+/* ---------------------------------------------------------------------------
+ * Sort
+ * ------------------------------------------------------------------------- */
+
+typedef struct SortRunJob {
+    Array * array;
+    int begin, end;
+    int (*compare)(void * a, void * b);
+    int failed;                 /* set if array_sort failed on the run */
+} SortRunJob;
+
+static void sort_run_job(void * arg) {
+    SortRunJob * job = arg;
+    Array view = *job->array;
+
+    view.list = (char *) job->array->list + (size_t) job->begin * job->array->elem_size;
+    view.num_elem = view.total_size = job->end - job->begin;
+    job->failed = array_sort(&view, job->compare);
+}
+
+/* One piece of the merge of runs a and b into dst. Pieces of the same merge
+ * are independent: each one starts where the previous one stopped. */
+typedef struct MergeJob {
+    const char * a; int a_len;
+    const char * b; int b_len;
+    char * dst;
+    int out_begin, out_end;     /* range of the merged output this piece writes */
+    size_t size;
+    int (*compare)(void * a, void * b);
+} MergeJob;
+
+#define ELEM(p, i, size) ((char *) (p) + (size_t) (i) * (size))
+
+/* Number of elements of a among the first d of the merge of a and b, with
+ * ties going to a first */
+static int co_rank(const MergeJob * job, int d) {
+    int lo = d - job->b_len > 0 ? d - job->b_len : 0;
+    int hi = d < job->a_len ? d : job->a_len;
+
+    while (lo < hi) {
+        int i = lo + (hi - lo) / 2, j = d - i;
+        if (j > 0 && i < job->a_len
+            && job->compare(ELEM(job->b, j - 1, job->size), ELEM(job->a, i, job->size)) >= 0)
+            lo = i + 1;
+        else
+            hi = i;
+    }
+    return lo;
+}
+
+static void merge_job(void * arg) {
+    MergeJob * job = arg;
+    size_t size = job->size;
+    int i = co_rank(job, job->out_begin), j = job->out_begin - i;
+    char * out = ELEM(job->dst, job->out_begin, size);
+
+    for (int d = job->out_begin; d < job->out_end; d++, out += size) {
+        if (j >= job->b_len
+            || (i < job->a_len && job->compare(ELEM(job->b, j, size), ELEM(job->a, i, size)) >= 0)) {
+            memcpy(out, ELEM(job->a, i, size), size);
+            i++;
+        } else {
+            memcpy(out, ELEM(job->b, j, size), size);
+            j++;
+        }
+    }
+}
+
+int array_parallel_sort(Scheduler * sched, Array * array, int (*compare)(void * a, void * b)) {
+    if (check_args(sched, array, (const void *) compare))
+        return 1;
+
+    Chunking c = make_chunking(sched, array);
+    if (c.num_chunks == 1)
+        return array_sort(array, compare);
+
+    size_t size = array->elem_size;
+    int n = array->num_elem;
+    int num_runs = c.num_chunks;
+
+    int * runs = malloc((num_runs + 1) * sizeof(int));
+    SortRunJob * sort_jobs = malloc(num_runs * sizeof(SortRunJob));
+    /* A merge round never has more pieces than the initial chunks plus one
+     * leftover per merged pair */
+    MergeJob * merge_jobs = malloc(2 * num_runs * sizeof(MergeJob));
+    char * scratch = malloc((size_t) n * size);
+
+    if (!runs || !sort_jobs || !merge_jobs || !scratch) {
+        fputs(PARALLEL_ALLOCATION_ERROR, stderr);
+        free(runs); free(sort_jobs); free(merge_jobs); free(scratch);
+        return 1;
+    }
+
+    for (int k = 0; k <= num_runs; k++)
+        runs[k] = chunk_start(&c, k);
+
+    for (int k = 0; k < num_runs; k++) {
+        sort_jobs[k].array = array;
+        sort_jobs[k].begin = runs[k];
+        sort_jobs[k].end = runs[k + 1];
+        sort_jobs[k].compare = compare;
+        sort_jobs[k].failed = 0;
+    }
+    run_jobs(sched, num_runs, sort_run_job, sort_jobs, sizeof(SortRunJob));
+
+    /* Merging an unsorted run would give a wrong result */
+    for (int k = 0; k < num_runs; k++) {
+        if (sort_jobs[k].failed) {
+            free(runs); free(sort_jobs); free(merge_jobs); free(scratch);
+            return 1;
+        }
+    }
+
+    char * src = array->list, * dst = scratch;
+    int piece = c.chunk_len;
+
+    while (num_runs > 1) {
+        int num_jobs = 0, merged = 0;
+
+        for (int r = 0; r < num_runs; r += 2) {
+            int begin = runs[r], mid = runs[r + 1];
+            int end = r + 2 <= num_runs ? runs[r + 2] : mid;
+
+            /* Pieces write [out, out + piece) of the merged output of the pair */
+            for (int out = 0; out < end - begin; out += piece) {
+                MergeJob * job = &merge_jobs[num_jobs++];
+                job->a = ELEM(src, begin, size); job->a_len = mid - begin;
+                job->b = ELEM(src, mid, size); job->b_len = end - mid;
+                job->dst = ELEM(dst, begin, size);
+                job->out_begin = out;
+                job->out_end = out + piece < end - begin ? out + piece : end - begin;
+                job->size = size;
+                job->compare = compare;
+            }
+            runs[merged++] = begin;
+        }
+        runs[merged] = n;
+        num_runs = merged;
+
+        run_jobs(sched, num_jobs, merge_job, merge_jobs, sizeof(MergeJob));
+
+        char * t = src; src = dst; dst = t;
+    }
+
+    if (src != array->list)
+        memcpy(array->list, src, (size_t) n * size);
+
+    free(runs); free(sort_jobs); free(merge_jobs); free(scratch);
+    return 0;
+}
+
+#undef ELEM
+
+/* ---------------------------------------------------------------------------
+ * Reduce
+ * ------------------------------------------------------------------------- */
+
+typedef struct ReduceJob {
+    Array * array;
+    int begin, end;
+    void * acc;
+    void (*fold)(void * acc, void * elem);
+} ReduceJob;
+
+static void reduce_job(void * arg) {
+    ReduceJob * job = arg;
+    size_t size = job->array->elem_size;
+    char * elem = (char *) job->array->list + (size_t) job->begin * size;
+
+    for (int i = job->begin; i < job->end; i++, elem += size)
+        job->fold(job->acc, elem);
+}
+
+int array_parallel_reduce(Scheduler * sched, Array * array, void * acc, size_t acc_size,
+                          void (*fold)(void * acc, void * elem),
+                          void (*combine)(void * acc, void * other)) {
+    if (check_args(sched, array, (const void *) fold) || check_args(sched, array, (const void *) combine))
+        return 1;
+
+    Chunking c = make_chunking(sched, array);
+
+    /* Partial accumulators get whole cache lines each */
+    size_t stride = (acc_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    char * partials = aligned_alloc(CACHE_LINE, stride * c.num_chunks);
+    ReduceJob * jobs = malloc(c.num_chunks * sizeof(ReduceJob));
+
+    if (!partials || !jobs) {
+        fputs(PARALLEL_ALLOCATION_ERROR, stderr);
+        free(partials); free(jobs);
+        return 1;
+    }
+
+    for (int k = 0; k < c.num_chunks; k++) {
+        jobs[k].array = array;
+        jobs[k].begin = chunk_start(&c, k);
+        jobs[k].end = chunk_start(&c, k + 1);
+        jobs[k].acc = partials + k * stride;
+        jobs[k].fold = fold;
+        memcpy(jobs[k].acc, acc, acc_size);
+    }
+
+    run_jobs(sched, c.num_chunks, reduce_job, jobs, sizeof(ReduceJob));
+
+    for (int k = 0; k < c.num_chunks; k++)
+        combine(acc, jobs[k].acc);
+
+    free(partials); free(jobs);
+    return 0;
+}
@@ -0,0 +1,89 @@
+#ifndef ARRAY_PARALLEL_H
+#define ARRAY_PARALLEL_H
+
+#include "array.h"
+#include "scheduler.h"
+
+/**
+ * @file array_parallel.h
+ * @brief Parallel versions of the Array algorithms.
+ *
+ * Every function runs on a Scheduler, which acts as a reusable thread pool: the
+ * number of threads is the one given to scheduler_init, and the same scheduler
+ * can be shared by any number of calls. The calling thread also takes part in
+ * the work while it waits.
+ *
+ * Arrays are split in chunks whose boundaries fall on 64 bytes cache lines
+ * whenever elem_size and the list address allow it, so two threads never write
+ * to the same cache line. Arrays too small to be worth splitting are processed
+ * by the calling thread alone.
+ */
+
+/**
+ * @brief Calls a function on every element of the array, in parallel
+ *
+ * The order in which the elements are visited is unspecified.
+ *
+ * @param sched Scheduler running the work
+ *
+ * @param array Pointer to the array
+ *
+ * @param fn Function called with a pointer to each element and ctx
+ *
+ * @param ctx User context given to fn
+ *
+ * @return 0 on success, 1 otherwise.
+ */
+int array_parallel_for_each(Scheduler * sched, Array * array, void (*fn)(void * elem, void * ctx), void * ctx);
+
+/**
+ * @brief Searches for the first element equal to x, in parallel
+ *
+ * Chunks are searched concurrently, and once a match is found the chunks
+ * after it stop early. See array_search for the compare function.
+ *
+ * @return The index of the first match, or -1 if there is none or the
+ *         parameters are invalid.
+ */
+int array_parallel_search(Scheduler * sched, Array * array, void * x, int (*compare)(void * a, void * b));
+
+/**
+ * @brief Sorts the array in parallel
+ *
+ * It sorts one run per chunk with array_sort and then merges the runs in
+ * rounds. Every merge is split in independent pieces by binary searching the
+ * split points, so all threads stay busy until the last round. It needs
+ * num_elem * elem_size bytes of scratch memory. The sort is not stable.
+ *
+ * @return 0 if the array was sorted, 1 otherwise. On failure the array holds
+ *         the same elements in an unspecified order.
+ */
+int array_parallel_sort(Scheduler * sched, Array * array, int (*compare)(void * a, void * b));
+
+/**
+ * @brief Reduces the array to a single value, in parallel
+ *
+ * Each chunk folds its elements into a private copy of acc, and the partial
+ * results are then combined into acc in chunk order. fold and combine must be
+ * associative and acc must hold their identity value when called, so the
+ * result doesn't depend on how the array was split.
+ *
+ * @param sched Scheduler running the work
+ *
+ * @param array Pointer to the array
+ *
+ * @param acc Holds the identity value on input and the result on output
+ *
+ * @param acc_size Size in bytes of acc
+ *
+ * @param fold Folds one element into an accumulator: fold(acc, elem)
+ *
+ * @param combine Folds a partial result into an accumulator: combine(acc, other)
+ *
+ * @return 0 on success, 1 otherwise.
+ */
+int array_parallel_reduce(Scheduler * sched, Array * array, void * acc, size_t acc_size,
+                          void (*fold)(void * acc, void * elem),
+                          void (*combine)(void * acc, void * other));
+
+#endif
@@ -0,0 +1,410 @@
+#include "array_scan.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+#define ARRAY_NULL_POINTER "Array pointer parameter is NULL"
+
+#define NULL_KEY_POINTER "Key pointer parameter is NULL"
+
+#define KEY_TYPE_SIZE_MISMATCH "Array elem_size does not match the key type size"
+
+static size_t key_type_size(ArrayKeyType type) {
+    switch (type) {
+        case ARRAY_KEY_I8:  case ARRAY_KEY_U8:  return 1;
+        case ARRAY_KEY_I16: case ARRAY_KEY_U16: return 2;
+        case ARRAY_KEY_I32: case ARRAY_KEY_U32: case ARRAY_KEY_FLOAT: return 4;
+        case ARRAY_KEY_I64: case ARRAY_KEY_U64: case ARRAY_KEY_DOUBLE: return 8;
+    }
+    return 0;
+}
+
+/* Returns 0 if the array can be scanned as the given type, 1 otherwise */
+static int scan_check(Array * array, ArrayKeyType type) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (array->elem_size != key_type_size(type)) {
+        fputs(KEY_TYPE_SIZE_MISMATCH, stderr);
+        return 1;
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * Bitwise equality kernels, one per element width. They return the index of
+ * the first match (n if there is none) or the number of matches.
+ * ------------------------------------------------------------------------- */
+
+typedef size_t (*eq_kernel)(const void * v, size_t n, const void * key);
+
+#define SCALAR_EQ_DEFINE(W, T)                                              \
+static size_t find_eq_scalar_##W(const void * v, size_t n, const void * key) { \
+    const T * p = v;                                                        \
+    T k;                                                                    \
+    memcpy(&k, key, W);                                                     \
+    for (size_t i = 0; i < n; i++)                                          \
+        if (p[i] == k)                                                      \
+            return i;                                                       \
+    return n;                                                               \
+}                                                                           \
+static size_t count_eq_scalar_##W(const void * v, size_t n, const void * key) { \
+    const T * p = v;                                                        \
+    size_t count = 0;                                                       \
+    T k;                                                                    \
+    memcpy(&k, key, W);                                                     \
+    for (size_t i = 0; i < n; i++)                                          \
+        count += p[i] == k;                                                 \
+    return count;                                                           \
+}
+
+SCALAR_EQ_DEFINE(1, uint8_t)
+SCALAR_EQ_DEFINE(2, uint16_t)
+SCALAR_EQ_DEFINE(4, uint32_t)
+SCALAR_EQ_DEFINE(8, uint64_t)
+
+#ifdef SCAN_X86
+
+#define SSE2 __attribute__((target("sse2")))
+#define AVX2 __attribute__((target("avx2")))
+
+/* Broadcast of the key and lane compare for each width. SSE2 has no 64 bits
+ * compare, so it is built from two 32 bits ones. */
+SSE2 static inline __m128i sse2_set1_1(const void * k) { return _mm_set1_epi8(*(const char *) k); }
+SSE2 static inline __m128i sse2_set1_2(const void * k) { int16_t x; memcpy(&x, k, 2); return _mm_set1_epi16(x); }
+SSE2 static inline __m128i sse2_set1_4(const void * k) { int32_t x; memcpy(&x, k, 4); return _mm_set1_epi32(x); }
+SSE2 static inline __m128i sse2_set1_8(const void * k) { int64_t x; memcpy(&x, k, 8); return _mm_set1_epi64x(x); }
+SSE2 static inline __m128i sse2_cmpeq_1(__m128i a, __m128i b) { return _mm_cmpeq_epi8(a, b); }
+SSE2 static inline __m128i sse2_cmpeq_2(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+SSE2 static inline __m128i sse2_cmpeq_4(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+SSE2 static inline __m128i sse2_cmpeq_8(__m128i a, __m128i b) {
+    __m128i t = _mm_cmpeq_epi32(a, b);
+    return _mm_and_si128(t, _mm_shuffle_epi32(t, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+AVX2 static inline __m256i avx2_set1_1(const void * k) { return _mm256_set1_epi8(*(const char *) k); }
+AVX2 static inline __m256i avx2_set1_2(const void * k) { int16_t x; memcpy(&x, k, 2); return _mm256_set1_epi16(x); }
+AVX2 static inline __m256i avx2_set1_4(const void * k) { int32_t x; memcpy(&x, k, 4); return _mm256_set1_epi32(x); }
+AVX2 static inline __m256i avx2_set1_8(const void * k) { int64_t x; memcpy(&x, k, 8); return _mm256_set1_epi64x(x); }
+AVX2 static inline __m256i avx2_cmpeq_1(__m256i a, __m256i b) { return _mm256_cmpeq_epi8(a, b); }
+AVX2 static inline __m256i avx2_cmpeq_2(__m256i a, __m256i b) { return _mm256_cmpeq_epi16(a, b); }
+AVX2 static inline __m256i avx2_cmpeq_4(__m256i a, __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+AVX2 static inline __m256i avx2_cmpeq_8(__m256i a, __m256i b) { return _mm256_cmpeq_epi64(a, b); }
+
+/* The byte mask of a compare has W bits set per matching lane, so the first
+ * match is at bit ctz / W and the number of matches is popcount / W. The tail
+ * that doesn't fill a vector goes through the scalar kernel. */
+#define VECTOR_EQ_DEFINE(ATTR, ISA, W, VEC, LOAD, MOVEMASK)                  \
+ATTR static size_t find_eq_##ISA##_##W(const void * v, size_t n, const void * key) { \
+    const char * p = v;                                                     \
+    const size_t lanes = sizeof(VEC) / W;                                   \
+    VEC k = ISA##_set1_##W(key);                                            \
+    size_t i = 0;                                                           \
+    for (; i + lanes <= n; i += lanes) {                                    \
+        unsigned mask = (unsigned) MOVEMASK(ISA##_cmpeq_##W(LOAD((const VEC *) (p + i * W)), k)); \
+        if (mask)                                                           \
+            return i + __builtin_ctz(mask) / W;                             \
+    }                                                                       \
+    return i + find_eq_scalar_##W(p + i * W, n - i, key);                   \
+}                                                                           \
+ATTR static size_t count_eq_##ISA##_##W(const void * v, size_t n, const void * key) { \
+    const char * p = v;                                                     \
+    const size_t lanes = sizeof(VEC) / W;                                   \
+    VEC k = ISA##_set1_##W(key);                                            \
+    size_t i = 0, bits = 0;                                                 \
+    for (; i + lanes <= n; i += lanes) {                                    \
+        unsigned mask = (unsigned) MOVEMASK(ISA##_cmpeq_##W(LOAD((const VEC *) (p + i * W)), k)); \
+        bits += __builtin_popcount(mask);                                   \
+    }                                                                       \
+    return bits / W + count_eq_scalar_##W(p + i * W, n - i, key);           \
+}
+
+#define SSE2_EQ_DEFINE(W) VECTOR_EQ_DEFINE(SSE2, sse2, W, __m128i, _mm_loadu_si128, _mm_movemask_epi8)
+#define AVX2_EQ_DEFINE(W) VECTOR_EQ_DEFINE(AVX2, avx2, W, __m256i, _mm256_loadu_si256, _mm256_movemask_epi8)
+
+SSE2_EQ_DEFINE(1)
+SSE2_EQ_DEFINE(2)
+SSE2_EQ_DEFINE(4)
+SSE2_EQ_DEFINE(8)
+
+AVX2_EQ_DEFINE(1)
+AVX2_EQ_DEFINE(2)
+AVX2_EQ_DEFINE(4)
+AVX2_EQ_DEFINE(8)
+
+#endif /* SCAN_X86 */
+
+static int width_slot(size_t width) {
+    switch (width) {
+        case 1: return 0;
+        case 2: return 1;
+        case 4: return 2;
+        default: return 3;
+    }
+}
+
+/* Picks the widest instruction set the running CPU supports */
+static eq_kernel find_eq_kernel(size_t width) {
+#ifdef SCAN_X86
+    static const eq_kernel avx2[] = { find_eq_avx2_1, find_eq_avx2_2, find_eq_avx2_4, find_eq_avx2_8 };
+    static const eq_kernel sse2[] = { find_eq_sse2_1, find_eq_sse2_2, find_eq_sse2_4, find_eq_sse2_8 };
+    if (__builtin_cpu_supports("avx2"))
+        return avx2[width_slot(width)];
+    if (__builtin_cpu_supports("sse2"))
+        return sse2[width_slot(width)];
+#endif
+    static const eq_kernel scalar[] = { find_eq_scalar_1, find_eq_scalar_2, find_eq_scalar_4, find_eq_scalar_8 };
+    return scalar[width_slot(width)];
+}
+
+static eq_kernel count_eq_kernel(size_t width) {
+#ifdef SCAN_X86
+    static const eq_kernel avx2[] = { count_eq_avx2_1, count_eq_avx2_2, count_eq_avx2_4, count_eq_avx2_8 };
+    static const eq_kernel sse2[] = { count_eq_sse2_1, count_eq_sse2_2, count_eq_sse2_4, count_eq_sse2_8 };
+    if (__builtin_cpu_supports("avx2"))
+        return avx2[width_slot(width)];
+    if (__builtin_cpu_supports("sse2"))
+        return sse2[width_slot(width)];
+#endif
+    static const eq_kernel scalar[] = { count_eq_scalar_1, count_eq_scalar_2, count_eq_scalar_4, count_eq_scalar_8 };
+    return scalar[width_slot(width)];
+}
+
+/*
+ * Floating point equality matches bitwise equality except for zeros (0.0 and
+ * -0.0 are equal) and NaNs (never equal). Keys that are neither go through
+ * the bitwise kernels, the other ones through these typed loops.
+ */
+typedef enum FloatKey { FLOAT_KEY_PLAIN, FLOAT_KEY_ZERO, FLOAT_KEY_NAN } FloatKey;
+
+static FloatKey classify_float_key(ArrayKeyType type, void * key) {
+    double d;
+    if (type == ARRAY_KEY_FLOAT) {
+        float f;
+        memcpy(&f, key, sizeof(f));
+        d = f;
+    } else {
+        memcpy(&d, key, sizeof(d));
+    }
+
+    if (d != d)
+        return FLOAT_KEY_NAN;
+    return d == 0.0 ? FLOAT_KEY_ZERO : FLOAT_KEY_PLAIN;
+}
+
+static size_t find_zero(Array * array, ArrayKeyType type, int count) {
+    size_t n = array->num_elem, matches = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        int zero = type == ARRAY_KEY_FLOAT ? ((float *) array->list)[i] == 0.0f
+                                           : ((double *) array->list)[i] == 0.0;
+        if (zero && !count)
+            return i;
+        matches += zero;
+    }
+    return count ? matches : n;
+}
+
+int array_find_eq(Array * array, ArrayKeyType type, void * key) {
+    if (scan_check(array, type))
+        return -1;
+    else if (!key) {
+        fputs(NULL_KEY_POINTER, stderr);
+        return -1;
+    }
+
+    size_t n = array->num_elem, i;
+
+    if (type == ARRAY_KEY_FLOAT || type == ARRAY_KEY_DOUBLE) {
+        switch (classify_float_key(type, key)) {
+            case FLOAT_KEY_NAN: return -1;
+            case FLOAT_KEY_ZERO:
+                i = find_zero(array, type, 0);
+                return i < n ? (int) i : -1;
+            case FLOAT_KEY_PLAIN: break;
+        }
+    }
+
+    i = find_eq_kernel(array->elem_size)(array->list, n, key);
+    return i < n ? (int) i : -1;
+}
+
+int array_count_eq(Array * array, ArrayKeyType type, void * key) {
+    if (scan_check(array, type))
+        return -1;
+    else if (!key) {
+        fputs(NULL_KEY_POINTER, stderr);
+        return -1;
+    }
+
+    if (type == ARRAY_KEY_FLOAT || type == ARRAY_KEY_DOUBLE) {
+        switch (classify_float_key(type, key)) {
+            case FLOAT_KEY_NAN: return 0;
+            case FLOAT_KEY_ZERO: return (int) find_zero(array, type, 1);
+            case FLOAT_KEY_PLAIN: break;
+        }
+    }
+
+    return (int) count_eq_kernel(array->elem_size)(array->list, array->num_elem, key);
+}
+
+/* ---------------------------------------------------------------------------
+ * Minimum, maximum and range filter
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Integer min/max are done in two steps: a branch free reduction for the
+ * extreme value, which compilers vectorize, followed by an equality scan for
+ * its first index. On x86 the reduction is also built for AVX2 and chosen at
+ * run time like the equality kernels.
+ */
+#define INT_EXTREME_DEFINE(ATTR, NAME, T)                                   \
+ATTR static T NAME##_min(const T * p, size_t n) {                           \
+    T m = p[0];                                                             \
+    for (size_t i = 1; i < n; i++)                                          \
+        m = p[i] < m ? p[i] : m;                                            \
+    return m;                                                               \
+}                                                                           \
+ATTR static T NAME##_max(const T * p, size_t n) {                           \
+    T m = p[0];                                                             \
+    for (size_t i = 1; i < n; i++)                                          \
+        m = p[i] > m ? p[i] : m;                                            \
+    return m;                                                               \
+}
+
+#ifdef SCAN_X86
+#define INT_EXTREME_DEFINE_ALL(NAME, T)                                     \
+    INT_EXTREME_DEFINE(, NAME##_scalar, T)                                  \
+    INT_EXTREME_DEFINE(AVX2, NAME##_avx2, T)                                \
+    static T NAME##_min(const T * p, size_t n) {                            \
+        return __builtin_cpu_supports("avx2") ? NAME##_avx2_min(p, n) : NAME##_scalar_min(p, n); \
+    }                                                                       \
+    static T NAME##_max(const T * p, size_t n) {                            \
+        return __builtin_cpu_supports("avx2") ? NAME##_avx2_max(p, n) : NAME##_scalar_max(p, n); \
+    }
+#else
+#define INT_EXTREME_DEFINE_ALL(NAME, T) INT_EXTREME_DEFINE(, NAME, T)
+#endif
+
+INT_EXTREME_DEFINE_ALL(i8, int8_t)
+INT_EXTREME_DEFINE_ALL(u8, uint8_t)
+INT_EXTREME_DEFINE_ALL(i16, int16_t)
+INT_EXTREME_DEFINE_ALL(u16, uint16_t)
+INT_EXTREME_DEFINE_ALL(i32, int32_t)
+INT_EXTREME_DEFINE_ALL(u32, uint32_t)
+INT_EXTREME_DEFINE_ALL(i64, int64_t)
+INT_EXTREME_DEFINE_ALL(u64, uint64_t)
+
+/* Floating point extremes skip NaNs, so they track the index directly */
+#define FLOAT_EXTREME_DEFINE(NAME, T)                                       \
+static int NAME##_find_extreme(const T * p, size_t n, int want_max) {       \
+    int best = -1;                                                          \
+    for (size_t i = 0; i < n; i++) {                                        \
+        if (p[i] != p[i])                                                   \
+            continue;                                                       \
+        if (best < 0 || (want_max ? p[i] > p[best] : p[i] < p[best]))       \
+            best = (int) i;                                                 \
+    }                                                                       \
+    return best;                                                            \
+}
+
+FLOAT_EXTREME_DEFINE(f32, float)
+FLOAT_EXTREME_DEFINE(f64, double)
+
+static int find_extreme(Array * array, ArrayKeyType type, int want_max) {
+    if (scan_check(array, type) || array->num_elem == 0)
+        return -1;
+
+    const void * p = array->list;
+    size_t n = array->num_elem;
+    uint64_t value = 0;     /* room for the extreme value of any width */
+
+#define EXTREME_CASE(TAG, NAME, T)                                          \
+    case TAG: {                                                             \
+        T m = want_max ? NAME##_max(p, n) : NAME##_min(p, n);               \
+        memcpy(&value, &m, sizeof(T));                                      \
+        break;                                                              \
+    }
+
+    switch (type) {
+        EXTREME_CASE(ARRAY_KEY_I8, i8, int8_t)
+        EXTREME_CASE(ARRAY_KEY_U8, u8, uint8_t)
+        EXTREME_CASE(ARRAY_KEY_I16, i16, int16_t)
+        EXTREME_CASE(ARRAY_KEY_U16, u16, uint16_t)
+        EXTREME_CASE(ARRAY_KEY_I32, i32, int32_t)
+        EXTREME_CASE(ARRAY_KEY_U32, u32, uint32_t)
+        EXTREME_CASE(ARRAY_KEY_I64, i64, int64_t)
+        EXTREME_CASE(ARRAY_KEY_U64, u64, uint64_t)
+        case ARRAY_KEY_FLOAT: return f32_find_extreme(p, n, want_max);
+        case ARRAY_KEY_DOUBLE: return f64_find_extreme(p, n, want_max);
+    }
+
+#undef EXTREME_CASE
+
+    return (int) find_eq_kernel(array->elem_size)(p, n, &value);
+}
+
+int array_find_min(Array * array, ArrayKeyType type) {
+    return find_extreme(array, type, 0);
+}
+
+int array_find_max(Array * array, ArrayKeyType type) {
+    return find_extreme(array, type, 1);
+}
+
+/* The index is always stored and the output cursor only moves on a match,
+ * which keeps the loop free of unpredictable branches */
+#define RANGE_DEFINE(NAME, T)                                               \
+static int NAME##_filter_range(const T * p, size_t n, const void * lo_key, const void * hi_key, int * out) { \
+    T lo, hi;                                                               \
+    memcpy(&lo, lo_key, sizeof(T));                                         \
+    memcpy(&hi, hi_key, sizeof(T));                                         \
+    int count = 0;                                                          \
+    for (size_t i = 0; i < n; i++) {                                        \
+        out[count] = (int) i;                                               \
+        count += (p[i] >= lo) & (p[i] <= hi);                               \
+    }                                                                       \
+    return count;                                                           \
+}
+
+RANGE_DEFINE(i8, int8_t)
+RANGE_DEFINE(u8, uint8_t)
+RANGE_DEFINE(i16, int16_t)
+RANGE_DEFINE(u16, uint16_t)
+RANGE_DEFINE(i32, int32_t)
+RANGE_DEFINE(u32, uint32_t)
+RANGE_DEFINE(i64, int64_t)
+RANGE_DEFINE(u64, uint64_t)
+RANGE_DEFINE(f32, float)
+RANGE_DEFINE(f64, double)
+
+int array_filter_range(Array * array, ArrayKeyType type, void * lo, void * hi, int * out) {
+    if (scan_check(array, type))
+        return -1;
+    else if (!lo || !hi || !out) {
+        fputs(NULL_KEY_POINTER, stderr);
+        return -1;
+    }
+
+    const void * p = array->list;
+    size_t n = array->num_elem;
+
+    switch (type) {
+        case ARRAY_KEY_I8:     return i8_filter_range(p, n, lo, hi, out);
+        case ARRAY_KEY_U8:     return u8_filter_range(p, n, lo, hi, out);
+        case ARRAY_KEY_I16:    return i16_filter_range(p, n, lo, hi, out);
+        case ARRAY_KEY_U16:    return u16_filter_range(p, n, lo, hi, out);
+        case ARRAY_KEY_I32:    return i32_filter_range(p, n, lo, hi, out);
+        case ARRAY_KEY_U32:    return u32_filter_range(p, n, lo, hi, out);
+        case ARRAY_KEY_I64:    return i64_filter_range(p, n, lo, hi, out);
+        case ARRAY_KEY_U64:    return u64_filter_range(p, n, lo, hi, out);
+        case ARRAY_KEY_FLOAT:  return f32_filter_range(p, n, lo, hi, out);
+        case ARRAY_KEY_DOUBLE: return f64_filter_range(p, n, lo, hi, out);
+    }
+    return -1;
+}
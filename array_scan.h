@@ -0,0 +1,103 @@
+#ifndef ARRAY_SCAN_H
+#define ARRAY_SCAN_H
+
+#include "array.h"
+
+/**
+ * @file array_scan.h
+ * @brief Search and count kernels for arrays of primitive elements.
+ *
+ * Unlike array_search, these functions don't call a comparison function per
+ * element. The caller tells which primitive type the elements hold and the
+ * scan is done by typed loops. On x86 processors, equality scans use SSE2 or
+ * AVX2 instructions, chosen at run time according to what the CPU supports.
+ * Other architectures use the portable scalar loops.
+ *
+ * All functions check that the array elem_size matches the size of the given
+ * type and fail otherwise.
+ */
+
+/**
+ * @brief Primitive type held by the array elements
+ */
+typedef enum ArrayKeyType {
+    ARRAY_KEY_I8,
+    ARRAY_KEY_U8,
+    ARRAY_KEY_I16,
+    ARRAY_KEY_U16,
+    ARRAY_KEY_I32,
+    ARRAY_KEY_U32,
+    ARRAY_KEY_I64,
+    ARRAY_KEY_U64,
+    ARRAY_KEY_FLOAT,
+    ARRAY_KEY_DOUBLE
+} ArrayKeyType;
+
+/**
+ * @brief Finds the first element equal to key
+ *
+ * Floating point elements are compared by value, so 0.0 matches -0.0 and
+ * a NaN key matches nothing.
+ *
+ * @param array Pointer to the array to be scanned
+ *
+ * @param type The type of the array elements
+ *
+ * @param key Pointer to a value of the given type
+ *
+ * @return The index of the first match, or -1 if there is none or the
+ *         parameters are invalid.
+ */
+int array_find_eq(Array * array, ArrayKeyType type, void * key);
+
+/**
+ * @brief Counts the elements equal to key
+ *
+ * It follows the same equality rules as array_find_eq.
+ *
+ * @return The number of matches, or -1 if the parameters are invalid.
+ */
+int array_count_eq(Array * array, ArrayKeyType type, void * key);
+
+/**
+ * @brief Finds the smallest element of the array
+ *
+ * NaN elements are ignored.
+ *
+ * @return The index of the first occurrence of the smallest element, or -1 if
+ *         the array is empty, holds only NaNs or the parameters are invalid.
+ */
+int array_find_min(Array * array, ArrayKeyType type);
+
+/**
+ * @brief Finds the largest element of the array
+ *
+ * NaN elements are ignored.
+ *
+ * @return The index of the first occurrence of the largest element, or -1 if
+ *         the array is empty, holds only NaNs or the parameters are invalid.
+ */
+int array_find_max(Array * array, ArrayKeyType type);
+
+/**
+ * @brief Collects the indices of the elements inside a closed range
+ *
+ * Every element x such that lo <= x <= hi has its index written to out, in
+ * increasing order.
+ *
+ * @param array Pointer to the array to be scanned
+ *
+ * @param type The type of the array elements
+ *
+ * @param lo Pointer to the lower bound of the range
+ *
+ * @param hi Pointer to the upper bound of the range
+ *
+ * @param out Buffer for the indices. It must have room for num_elem integers.
+ *
+ * @return The number of indices written to out, or -1 if the parameters
+ *         are invalid.
+ */
+int array_filter_range(Array * array, ArrayKeyType type, void * lo, void * hi, int * out);
+
+#endif
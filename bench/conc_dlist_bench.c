@@ -0,0 +1,209 @@
+/*
+ * Throughput of the concurrent sorted list against a Dlist wrapped in a single
+ * mutex, the way shared ordered sets were kept before.
+ *
+ * Each thread runs a mix of lookups, insertions and removals of random keys on
+ * a list prefilled to half of the key range, for a fixed time. The benchmark
+ * reports the total operations per second for 1, 2, 4, ... threads up to the
+ * given maximum.
+ *
+ * Build and run from the repository root:
+ *
+ *      gcc -std=c11 -O2 -pthread -I. bench/conc_dlist_bench.c conc_dlist.c epoch.c dlist.c linked_list.c array.c bloom.c allocator.c region.c -lm -o conc_dlist_bench
+ *      ./conc_dlist_bench [max threads] [key range] [lookup percentage] [seconds per run]
+ */
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "conc_dlist.h"
+#include "dlist.h"
+
+static int key_range = 4096;
+static int lookup_percent = 80;
+static double seconds = 1.0;
+
+static int * keys;          /* keys[k] == k, so elements never need allocating */
+static atomic_int stop;
+
+static int compare(void * a, void * b) {
+    int x = *(int *) a, y = *(int *) b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t next_random(uint64_t * state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* ---------------------------------------------------------------------------
+ * Baseline: sorted Dlist under one mutex
+ * ------------------------------------------------------------------------- */
+
+typedef struct LockedDlist {
+    Dlist * dlist;
+    pthread_mutex_t lock;
+} LockedDlist;
+
+/* First node not lower than x, or the head */
+static DlistNode * lower_bound(Dlist * dlist, int * x) {
+    DlistNode * head = dlist_head(dlist);
+    DlistNode * node = head->next;
+
+    while (node != head && compare(node->data, x) < 0)
+        node = node->next;
+    return node;
+}
+
+static int locked_op(LockedDlist * list, int op, int * x) {
+    pthread_mutex_lock(&list->lock);
+
+    DlistNode * node = lower_bound(list->dlist, x);
+    int found = node != dlist_head(list->dlist) && compare(node->data, x) == 0;
+
+    if (op == 1 && !found)
+        dlist_insert_prev(list->dlist, node, x);
+    else if (op == 2 && found)
+        dlist_remove_prev(list->dlist, node->next);
+
+    pthread_mutex_unlock(&list->lock);
+    return found;
+}
+
+/* ---------------------------------------------------------------------------
+ * Runs
+ * ------------------------------------------------------------------------- */
+
+typedef struct Run {
+    LockedDlist * locked;       /* baseline if not NULL */
+    ConcDlist * conc;
+    uint64_t seed;
+    long ops;
+} Run;
+
+/* 0 for a lookup, 1 for an insertion, 2 for a removal */
+static int pick_op(uint64_t r) {
+    int p = (int) ((r >> 40) % 100);
+    if (p < lookup_percent)
+        return 0;
+    return p % 2 ? 1 : 2;
+}
+
+static void * run_locked(void * arg) {
+    Run * run = arg;
+    long ops = 0;
+
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        uint64_t r = next_random(&run->seed);
+        locked_op(run->locked, pick_op(r), &keys[r % key_range]);
+        ops++;
+    }
+    run->ops = ops;
+    return NULL;
+}
+
+static void * run_conc(void * arg) {
+    Run * run = arg;
+    EpochRecord * record = conc_dlist_register(run->conc);
+    long ops = 0;
+
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        uint64_t r = next_random(&run->seed);
+        int * key = &keys[r % key_range];
+
+        switch (pick_op(r)) {
+        case 0: conc_dlist_contains(run->conc, record, key); break;
+        case 1: conc_dlist_insert(run->conc, record, key); break;
+        default: conc_dlist_remove(run->conc, record, key); break;
+        }
+        ops++;
+    }
+    conc_dlist_unregister(run->conc, record);
+    run->ops = ops;
+    return NULL;
+}
+
+/* Runs num_threads threads for the set time and returns operations per second */
+static double measure(int num_threads, LockedDlist * locked, ConcDlist * conc) {
+    pthread_t threads[num_threads];
+    Run runs[num_threads];
+
+    atomic_store(&stop, 0);
+    for (int i = 0; i < num_threads; i++) {
+        runs[i] = (Run) { locked, conc, 0x9e3779b97f4a7c15ULL * (i + 1), 0 };
+        pthread_create(&threads[i], NULL, locked ? run_locked : run_conc, &runs[i]);
+    }
+
+    double start = now();
+    struct timespec pause = { (time_t) seconds, (long) ((seconds - (time_t) seconds) * 1e9) };
+    nanosleep(&pause, NULL);
+    atomic_store(&stop, 1);
+
+    long total = 0;
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+        total += runs[i].ops;
+    }
+    return total / (now() - start);
+}
+
+int main(int argc, char ** argv) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+    if (argc > 2) key_range = atoi(argv[2]);
+    if (argc > 3) lookup_percent = atoi(argv[3]);
+    if (argc > 4) seconds = atof(argv[4]);
+
+    if (max_threads <= 0 || key_range <= 0 || lookup_percent < 0 || lookup_percent > 100 || seconds <= 0) {
+        fputs("usage: conc_dlist_bench [max threads] [key range] [lookup percentage] [seconds per run]\n", stderr);
+        return 2;
+    }
+
+    keys = malloc(key_range * sizeof(int));
+    if (!keys)
+        return 1;
+    for (int k = 0; k < key_range; k++)
+        keys[k] = k;
+
+    printf("%d keys, %d%% lookups, %.1f s per run\n", key_range, lookup_percent, seconds);
+    printf("%8s %16s %16s %8s\n", "threads", "mutex ops/s", "conc ops/s", "speedup");
+
+    for (int t = 1; t <= max_threads; t *= 2) {
+        /* Both lists start from the same half of the keys */
+        LockedDlist locked = { dlist_init(NULL), PTHREAD_MUTEX_INITIALIZER };
+        ConcDlist * conc = conc_dlist_init(compare, NULL);
+        if (!locked.dlist || !conc)
+            return 1;
+
+        EpochRecord * record = conc_dlist_register(conc);
+        for (int k = 0; k < key_range; k += 2) {
+            dlist_insert_prev(locked.dlist, dlist_head(locked.dlist), &keys[k]);
+            conc_dlist_insert(conc, record, &keys[k]);
+        }
+        conc_dlist_unregister(conc, record);
+
+        double base = measure(t, &locked, NULL);
+        double fine = measure(t, NULL, conc);
+        printf("%8d %16.0f %16.0f %7.2fx\n", t, base, fine, fine / base);
+
+        dlist_terminate(locked.dlist);
+        pthread_mutex_destroy(&locked.lock);
+        conc_dlist_terminate(conc);
+
+        if (t < max_threads && 2 * t > max_threads)
+            t = max_threads / 2;
+    }
+
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include "bloom.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define BLOOM_ALLOCATION_ERROR "Memory allocation error for the Bloom filter\n"
+
+#define BLOOM_NULL_POINTER "Bloom filter pointer parameter is NULL\n"
+
+#define BLOOM_NULL_HASH "Hash function pointer parameter is NULL\n"
+
+#define BLOOM_BLOCK_BITS 512
+
+#define BLOOM_BLOCK_WORDS (BLOOM_BLOCK_BITS / 64)
+
+#define BLOOM_DEFAULT_CAPACITY 1024
+
+#define BLOOM_DEFAULT_FP_RATE 0.01
+
+#define BLOOM_MAX_HASHES 16
+
+/* Sizes the bits for capacity elements at the target rate, within budget */
+static int bloom_size(Bloom * bloom, int capacity) {
+    double ln2 = 0.69314718055994530942;
+    double bits = -capacity * log(bloom->fp_rate) / (ln2 * ln2);
+
+    if (bloom->max_bytes > 0 && bits > bloom->max_bytes * 8.0)
+        bits = bloom->max_bytes * 8.0;
+
+    double blocks = ceil(bits / BLOOM_BLOCK_BITS);
+    if (blocks < 1)
+        blocks = 1;
+    else if (blocks > UINT32_MAX)
+        blocks = UINT32_MAX;
+
+    /* The best number of hashes for the bits actually given */
+    int hashes = (int) lround(blocks * BLOOM_BLOCK_BITS / capacity * ln2);
+    if (hashes < 1)
+        hashes = 1;
+    else if (hashes > BLOOM_MAX_HASHES)
+        hashes = BLOOM_MAX_HASHES;
+
+    uint64_t * bits_mem = aligned_alloc(64, (size_t) blocks * 64);
+    if (!bits_mem) {
+        fputs(BLOOM_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+    memset(bits_mem, 0, (size_t) blocks * 64);
+
+    free(bloom->bits);
+    bloom->bits = bits_mem;
+    bloom->num_blocks = (uint32_t) blocks;
+    bloom->num_hashes = hashes;
+    bloom->capacity = capacity;
+    bloom->num_items = 0;
+    bloom->stale = 0;
+    return 0;
+}
+
+Bloom * bloom_init(uint64_t (*hash)(void * data), int capacity, double fp_rate, size_t max_bytes) {
+    if (!hash) {
+        fputs(BLOOM_NULL_HASH, stderr);
+        return NULL;
+    }
+
+    Bloom * bloom = malloc(sizeof(Bloom));
+    if (!bloom) {
+        fputs(BLOOM_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    bloom->bits = NULL;
+    bloom->hash = hash;
+    bloom->fp_rate = fp_rate > 0 && fp_rate < 1 ? fp_rate : BLOOM_DEFAULT_FP_RATE;
+    bloom->max_bytes = max_bytes;
+
+    if (bloom_size(bloom, capacity > 0 ? capacity : BLOOM_DEFAULT_CAPACITY)) {
+        free(bloom);
+        return NULL;
+    }
+    return bloom;
+}
+
+void bloom_terminate(Bloom * bloom) {
+    if (!bloom) {
+        fputs(BLOOM_NULL_POINTER, stderr);
+        return;
+    }
+    free(bloom->bits);
+    free(bloom);
+}
+
+int bloom_reset(Bloom * bloom, int capacity) {
+    if (!bloom) {
+        fputs(BLOOM_NULL_POINTER, stderr);
+        return 1;
+    }
+
+    if (capacity <= 0)
+        capacity = BLOOM_DEFAULT_CAPACITY;
+
+    if (capacity == bloom->capacity) {
+        memset(bloom->bits, 0, bloom_bytes(bloom));
+        bloom->num_items = 0;
+        bloom->stale = 0;
+        return 0;
+    }
+
+    if (bloom_size(bloom, capacity)) {
+        bloom->stale = 1;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * The high half of the hash picks the block, and the bits inside it come from
+ * double hashing on a remix of the hash, so they don't depend on the block.
+ */
+#define BLOOM_PROBE(bloom, data, block, h1, h2)                                  \
+    uint64_t h = (bloom)->hash(data);                                           \
+    uint64_t * block = (bloom)->bits                                            \
+        + (((h >> 32) * (bloom)->num_blocks) >> 32) * BLOOM_BLOCK_WORDS;        \
+    uint64_t mixed = h * 0x9E3779B97F4A7C15ULL;                                 \
+    uint32_t h1 = (uint32_t) mixed, h2 = (uint32_t) (mixed >> 32) | 1
+
+void bloom_add(Bloom * bloom, void * data) {
+    BLOOM_PROBE(bloom, data, block, h1, h2);
+
+    for (int i = 0; i < bloom->num_hashes; i++, h1 += h2)
+        block[(h1 % BLOOM_BLOCK_BITS) / 64] |= 1ULL << (h1 % 64);
+
+    if (++bloom->num_items > bloom->capacity)
+        bloom->stale = 1;
+}
+
+int bloom_may_contain(const Bloom * bloom, void * data) {
+    BLOOM_PROBE(bloom, data, block, h1, h2);
+    uint64_t found = 1;
+
+    /* No early exit: the loop is short and its loads hit the same line */
+    for (int i = 0; i < bloom->num_hashes; i++, h1 += h2)
+        found &= block[(h1 % BLOOM_BLOCK_BITS) / 64] >> (h1 % 64);
+
+    return (int) found;
+}
+
+#undef BLOOM_PROBE
+
+double bloom_current_fp_rate(const Bloom * bloom) {
+    if (!bloom) {
+        fputs(BLOOM_NULL_POINTER, stderr);
+        return 1.0;
+    }
+
+    double bits = (double) bloom->num_blocks * BLOOM_BLOCK_BITS;
+    return pow(1.0 - exp(-bloom->num_hashes * (double) bloom->num_items / bits), bloom->num_hashes);
+}
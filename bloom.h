@@ -0,0 +1,113 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file bloom.h
+ * @brief Blocked Bloom filter for fast negative membership tests.
+ *
+ * A Bloom filter answers whether an element may be in a set: "no" is always
+ * right, while "maybe" is wrong with a small probability, the false positive
+ * rate. The filter is split in 64 bytes blocks and all the bits of an element
+ * fall in the same block, so a test touches a single cache line.
+ *
+ * Elements are hashed by a user function, which must give the same value for
+ * any two elements considered equal by the container compare function.
+ *
+ * Elements can't be removed from a Bloom filter. Containers mark their filter
+ * stale instead when an element is removed, or when more elements than the
+ * filter was sized for have been added, and rebuild it before the next search
+ * that uses it.
+ */
+
+/**
+ * @brief The Bloom filter structure
+ */
+typedef struct Bloom {
+    uint64_t * bits;                    /**< num_blocks blocks of 8 words. */
+    uint32_t num_blocks;                /**< Number of 512 bits blocks. */
+    int num_hashes;                     /**< Bits set per element. */
+    int capacity;                       /**< Elements the filter was sized for. */
+    int num_items;                      /**< Elements added since the last clear. */
+    int stale;                          /**< Set when the filter must be rebuilt before use. */
+    double fp_rate;                     /**< Target false positive rate. */
+    size_t max_bytes;                   /**< Memory budget for the bits, 0 for no limit. */
+    uint64_t (*hash)(void * data);      /**< Hash function of the elements. */
+} Bloom;
+
+/**
+ * @brief Initializes a new Bloom filter
+ *
+ * The filter gets the size that gives fp_rate for capacity elements, unless
+ * it exceeds max_bytes, in which case it gets max_bytes and a higher rate.
+ *
+ * @param hash Hash function of the elements
+ *
+ * @param capacity Number of elements expected. Non positive values use 1024.
+ *
+ * @param fp_rate Target false positive rate, between 0 and 1 exclusive.
+ *                Values out of range use 0.01.
+ *
+ * @param max_bytes Memory budget for the bits, 0 for no limit
+ *
+ * @return A pointer to the new filter, or NULL on error.
+ */
+Bloom * bloom_init(uint64_t (*hash)(void * data), int capacity, double fp_rate, size_t max_bytes);
+
+/**
+ * @brief Destroys the filter
+ */
+void bloom_terminate(Bloom * bloom);
+
+/**
+ * @brief Adds an element to the filter
+ *
+ * Once more than capacity elements are added the filter is marked stale, so
+ * its owner rebuilds it larger.
+ */
+void bloom_add(Bloom * bloom, void * data);
+
+/**
+ * @brief Tests whether an element may be in the filter
+ *
+ * @return 0 if the element was surely never added, 1 if it may have been.
+ */
+int bloom_may_contain(const Bloom * bloom, void * data);
+
+/**
+ * @brief Empties the filter and resizes it for a new number of elements
+ *
+ * It keeps the false positive rate and memory budget, and clears the stale mark.
+ *
+ * @param bloom Pointer to the filter
+ *
+ * @param capacity Number of elements expected. Non positive values use 1024.
+ *
+ * @return 0 on success, 1 if memory allocation fails, in which case the filter
+ *         is left stale.
+ */
+int bloom_reset(Bloom * bloom, int capacity);
+
+/**
+ * @brief Expected false positive rate with the elements added so far
+ */
+double bloom_current_fp_rate(const Bloom * bloom);
+
+/**
+ * @brief Marks the filter as stale
+ */
+#define bloom_invalidate(bloom) ((bloom)->stale = 1)
+
+/**
+ * @brief Whether the filter must be rebuilt before being used
+ */
+#define bloom_stale(bloom) ((bloom)->stale)
+
+/**
+ * @brief Memory used by the bits of the filter, in bytes
+ */
+#define bloom_bytes(bloom) ((size_t) (bloom)->num_blocks * 64)
+
+#endif
@@ -0,0 +1,358 @@
+#include "column_array.h"
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#define COLUMN_ARRAY_ALLOCATION_ERROR "Memory allocation error for the column array\n"
+
+#define COLUMN_ARRAY_NULL_POINTER "Column array pointer parameter is NULL\n"
+
+#define INVALID_SCHEMA "Column widths must be given and none of them can be 0\n"
+
+#define NULL_FIELDS_POINTER "Fields pointer parameter is NULL\n"
+
+#define NULL_COMPARE_POINTER "Param compare is null\n"
+
+#define COLUMN_OUT_OF_RANGE "Column index out of range\n"
+
+#define ROW_OUT_OF_RANGE "Row index out of range\n"
+
+#define COLUMN_ALIGNMENT 64
+
+#define ROUND_UP(size, align) (((size) + (align) - 1) / (align) * (align))
+
+/* Bytes of a column buffer with room for capacity rows */
+#define COLUMN_BYTES(width, capacity) ROUND_UP((size_t) (capacity) * (width), COLUMN_ALIGNMENT)
+
+ColumnArray * column_array_init(const size_t * widths, int num_columns, int init_size) {
+    if (!widths || num_columns <= 0) {
+        fputs(INVALID_SCHEMA, stderr);
+        return NULL;
+    }
+    for (int c = 0; c < num_columns; c++) {
+        if (widths[c] == 0) {
+            fputs(INVALID_SCHEMA, stderr);
+            return NULL;
+        }
+    }
+
+    ColumnArray * array = malloc(sizeof(ColumnArray));
+    if (!array) {
+        fputs(COLUMN_ARRAY_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    array->columns = calloc(num_columns, sizeof(void *));
+    array->widths = malloc(num_columns * sizeof(size_t));
+    array->num_columns = num_columns;
+    array->num_elem = 0;
+    array->total_size = init_size > 0 ? init_size : 0;
+
+    int failed = !array->columns || !array->widths;
+
+    for (int c = 0; c < num_columns && !failed; c++) {
+        array->widths[c] = widths[c];
+        if (array->total_size > 0) {
+            array->columns[c] = aligned_alloc(COLUMN_ALIGNMENT, COLUMN_BYTES(widths[c], array->total_size));
+            failed = !array->columns[c];
+        }
+    }
+
+    if (failed) {
+        fputs(COLUMN_ARRAY_ALLOCATION_ERROR, stderr);
+        if (array->columns)
+            for (int c = 0; c < num_columns; c++)
+                free(array->columns[c]);
+        free(array->columns);
+        free(array->widths);
+        free(array);
+        return NULL;
+    }
+
+    return array;
+}
+
+void column_array_terminate(ColumnArray * array) {
+    if (!array) {
+        fputs(COLUMN_ARRAY_NULL_POINTER, stderr);
+        return;
+    }
+
+    for (int c = 0; c < array->num_columns; c++)
+        free(array->columns[c]);
+    free(array->columns);
+    free(array->widths);
+    free(array);
+}
+
+/* Makes room for one more row in every column, doubling the capacity or
+ * starting at 10. Either all the columns grow or none does. */
+static int column_array_reserve_one(ColumnArray * array) {
+    if (array->num_elem < array->total_size)
+        return 0;
+    if (array->total_size > INT_MAX / 2) {
+        fputs(COLUMN_ARRAY_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    int new_size = array->total_size > 0 ? array->total_size * 2 : 10;
+    void ** grown = malloc(array->num_columns * sizeof(void *));
+    if (!grown) {
+        fputs(COLUMN_ARRAY_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    for (int c = 0; c < array->num_columns; c++) {
+        grown[c] = aligned_alloc(COLUMN_ALIGNMENT, COLUMN_BYTES(array->widths[c], new_size));
+        if (!grown[c]) {
+            fputs(COLUMN_ARRAY_ALLOCATION_ERROR, stderr);
+            while (c-- > 0)
+                free(grown[c]);
+            free(grown);
+            return 1;
+        }
+    }
+
+    for (int c = 0; c < array->num_columns; c++) {
+        if (array->num_elem > 0)
+            memcpy(grown[c], array->columns[c], (size_t) array->num_elem * array->widths[c]);
+        free(array->columns[c]);
+        array->columns[c] = grown[c];
+    }
+
+    free(grown);
+    array->total_size = new_size;
+    return 0;
+}
+
+int column_array_append(ColumnArray * array, void * const * fields) {
+    if (!array) {
+        fputs(COLUMN_ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (!fields) {
+        fputs(NULL_FIELDS_POINTER, stderr);
+        return 1;
+    }
+
+    if (column_array_reserve_one(array))
+        return 1;
+
+    for (int c = 0; c < array->num_columns; c++)
+        memcpy(column_array_at(array, c, array->num_elem), fields[c], array->widths[c]);
+
+    array->num_elem++;
+    return 0;
+}
+
+int column_array_remove_at(ColumnArray * array, int index) {
+    if (!array) {
+        fputs(COLUMN_ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (index < 0 || index >= array->num_elem) {
+        fputs(ROW_OUT_OF_RANGE, stderr);
+        return 1;
+    }
+
+    for (int c = 0; c < array->num_columns; c++)
+        memmove(column_array_at(array, c, index), column_array_at(array, c, index + 1),
+                (size_t) (array->num_elem - index - 1) * array->widths[c]);
+
+    array->num_elem--;
+    return 0;
+}
+
+/* Swaps two fields of the same width through a small buffer */
+static void swap_bytes(char * a, char * b, size_t n) {
+    char tmp[64];
+
+    while (n > 0) {
+        size_t chunk = n < sizeof(tmp) ? n : sizeof(tmp);
+        memcpy(tmp, a, chunk);
+        memcpy(a, b, chunk);
+        memcpy(b, tmp, chunk);
+        a += chunk;
+        b += chunk;
+        n -= chunk;
+    }
+}
+
+int column_array_swap(ColumnArray * array, int i, int j) {
+    if (!array) {
+        fputs(COLUMN_ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (i < 0 || i >= array->num_elem || j < 0 || j >= array->num_elem) {
+        fputs(ROW_OUT_OF_RANGE, stderr);
+        return 1;
+    }
+
+    if (i != j)
+        for (int c = 0; c < array->num_columns; c++)
+            swap_bytes(column_array_at(array, c, i), column_array_at(array, c, j), array->widths[c]);
+
+    return 0;
+}
+
+Array * column_array_view(ColumnArray * array, int column, Array * view) {
+    if (!array) {
+        fputs(COLUMN_ARRAY_NULL_POINTER, stderr);
+        return NULL;
+    } else if (column < 0 || column >= array->num_columns) {
+        fputs(COLUMN_OUT_OF_RANGE, stderr);
+        return NULL;
+    }
+
+    if (!array_init_in_place(view, array->columns[column], array->total_size, array->widths[column], NULL))
+        return NULL;
+
+    view->num_elem = array->num_elem;
+    return view;
+}
+
+int column_array_search(ColumnArray * array, int column, void * x, int (*compare)(void * a, void * b)) {
+    Array view;
+
+    if (!column_array_view(array, column, &view))
+        return -1;
+
+    char * found = array_search(&view, x, compare);
+    return found ? (int) ((found - (char *) view.list) / (ptrdiff_t) view.elem_size) : -1;
+}
+
+/* ---------------------------------------------------------------------------
+ * Sorting and selection work on records holding a copy of the key followed
+ * by its row number. The key is at the start of the record, so the compare
+ * function of the column works on records unchanged.
+ * ------------------------------------------------------------------------- */
+
+/* Offset of the row number, and length of a record keeping keys aligned */
+#define RECORD_ROW_OFFSET(width) ROUND_UP((width), _Alignof(int))
+#define RECORD_SIZE(width) ROUND_UP(RECORD_ROW_OFFSET(width) + sizeof(int), _Alignof(max_align_t))
+
+#define RECORD_ROW(record, width) (*(int *) ((char *) (record) + RECORD_ROW_OFFSET(width)))
+
+static Array * build_records(ColumnArray * array, int column) {
+    size_t width = array->widths[column];
+    Array * records = array_init(NULL, array->num_elem, RECORD_SIZE(width));
+    if (!records)
+        return NULL;
+
+    char * record = records->list;
+    for (int r = 0; r < array->num_elem; r++, record += records->elem_size) {
+        memcpy(record, column_array_at(array, column, r), width);
+        RECORD_ROW(record, width) = r;
+    }
+    records->num_elem = array->num_elem;
+
+    return records;
+}
+
+static int check_column(ColumnArray * array, int column, int (*compare)(void * a, void * b)) {
+    if (!array) {
+        fputs(COLUMN_ARRAY_NULL_POINTER, stderr);
+        return 1;
+    } else if (column < 0 || column >= array->num_columns) {
+        fputs(COLUMN_OUT_OF_RANGE, stderr);
+        return 1;
+    } else if (!compare) {
+        fputs(NULL_COMPARE_POINTER, stderr);
+        return 1;
+    }
+    return 0;
+}
+
+int column_array_sort(ColumnArray * array, int column, int (*compare)(void * a, void * b)) {
+    if (check_column(array, column, compare))
+        return 1;
+    if (array->num_elem < 2)
+        return 0;
+
+    size_t key_width = array->widths[column];
+    size_t max_bytes = 0;
+    for (int c = 0; c < array->num_columns; c++)
+        if ((size_t) array->num_elem * array->widths[c] > max_bytes)
+            max_bytes = (size_t) array->num_elem * array->widths[c];
+
+    Array * records = build_records(array, column);
+    char * spare = malloc(max_bytes);
+
+    if (!records || !spare || array_sort(records, compare)) {
+        if (!spare)
+            fputs(COLUMN_ARRAY_ALLOCATION_ERROR, stderr);
+        if (records)
+            array_terminate(records);
+        free(spare);
+        return 1;
+    }
+
+    /* Each column is gathered in sorted order into the spare buffer and
+     * copied back, so nothing can fail once the first column is changed */
+    for (int c = 0; c < array->num_columns; c++) {
+        size_t width = array->widths[c];
+        char * record = records->list;
+
+        for (int r = 0; r < array->num_elem; r++, record += records->elem_size)
+            memcpy(spare + (size_t) r * width, column_array_at(array, c, RECORD_ROW(record, key_width)), width);
+
+        memcpy(array->columns[c], spare, (size_t) array->num_elem * width);
+    }
+
+    array_terminate(records);
+    free(spare);
+    return 0;
+}
+
+int column_array_select(ColumnArray * array, int column, int k, int (*compare)(void * a, void * b)) {
+    if (check_column(array, column, compare))
+        return -1;
+    if (k < 0 || k >= array->num_elem)
+        return -1;
+
+    size_t key_width = array->widths[column];
+    Array * records = build_records(array, column);
+    char * pivot = records ? malloc(records->elem_size) : NULL;
+
+    if (!records || !pivot) {
+        fputs(COLUMN_ARRAY_ALLOCATION_ERROR, stderr);
+        if (records)
+            array_terminate(records);
+        return -1;
+    }
+
+    size_t size = records->elem_size;
+    char * base = records->list;
+    int lo = 0, hi = array->num_elem - 1;
+
+    /* Hoare partition around the middle record: after it, [lo, j] holds no
+     * record greater than the pivot, [i, hi] none smaller, and anything in
+     * between equals it */
+    while (lo < hi) {
+        memcpy(pivot, base + (size_t) (lo + (hi - lo) / 2) * size, size);
+        int i = lo, j = hi;
+
+        while (i <= j) {
+            while (compare(base + (size_t) i * size, pivot) < 0)
+                i++;
+            while (compare(base + (size_t) j * size, pivot) > 0)
+                j--;
+            if (i <= j) {
+                if (i != j)
+                    swap_bytes(base + (size_t) i * size, base + (size_t) j * size, size);
+                i++;
+                j--;
+            }
+        }
+
+        if (k <= j)
+            hi = j;
+        else if (k >= i)
+            lo = i;
+        else
+            break;
+    }
+
+    int row = RECORD_ROW(base + (size_t) k * size, key_width);
+
+    array_terminate(records);
+    free(pivot);
+    return row;
+}
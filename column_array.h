@@ -0,0 +1,136 @@
+#ifndef COLUMN_ARRAY_H
+#define COLUMN_ARRAY_H
+
+#include <stddef.h>
+#include "array.h"
+
+/**
+ * @file column_array.h
+ * @brief Array of records stored column by column.
+ *
+ * An Array keeps whole records one after the other, so a scan reading one
+ * field of each record still brings the other fields into the cache. A
+ * ColumnArray is declared with a schema, the width of each field, and keeps
+ * each field in its own contiguous buffer aligned to 64 bytes. A scan over
+ * one column then reads only that column.
+ *
+ * Row operations (append, remove, swap) keep all the columns in step. Any
+ * single column can be seen as a regular Array through column_array_view, so
+ * the array and array_scan functions that don't change its length run on it
+ * directly. Sorting and selection go through column_array_sort and
+ * column_array_select instead, so the other columns follow.
+ */
+
+/**
+ * @brief The column array structure
+ */
+typedef struct ColumnArray {
+    void ** columns;                //one buffer per column, aligned to 64 bytes
+    size_t * widths;                //length in bytes of a field of each column
+    int num_columns;                //number of columns
+    int num_elem;                   //number of rows
+    int total_size;                 //rows the buffers have room for
+} ColumnArray;
+
+/**
+ * @brief Initializes a new column array
+ *
+ * @param widths Width in bytes of each column, none of them 0. It's copied.
+ *
+ * @param num_columns Number of columns
+ *
+ * @param init_size Rows to make room for. Non positive values make no room.
+ *
+ * @return A pointer to the new column array, or NULL on error.
+ */
+ColumnArray * column_array_init(const size_t * widths, int num_columns, int init_size);
+
+/**
+ * @brief Destroys the column array
+ */
+void column_array_terminate(ColumnArray * array);
+
+/**
+ * @brief Appends a row
+ *
+ * @param array Pointer to the column array
+ *
+ * @param fields One pointer per column to the bytes of its field
+ *
+ * @return 0 if the row was appended, 1 otherwise.
+ */
+int column_array_append(ColumnArray * array, void * const * fields);
+
+/**
+ * @brief Removes the row at the given index, shifting the following ones
+ *
+ * @return 0 for successful removal, 1 otherwise.
+ */
+int column_array_remove_at(ColumnArray * array, int index);
+
+/**
+ * @brief Swaps two rows
+ *
+ * @return 0 on success, 1 if an index is out of range.
+ */
+int column_array_swap(ColumnArray * array, int i, int j);
+
+/**
+ * @brief Sees one column as an Array
+ *
+ * The view shares the column buffer: changes made through it show in the
+ * column array. It stays valid until the column array changes length, and
+ * it must not change length itself, so insertions and removals have to go
+ * through the column array.
+ *
+ * @param array Pointer to the column array
+ *
+ * @param column Index of the column
+ *
+ * @param view Array structure to fill in
+ *
+ * @return view, or NULL if the column doesn't exist.
+ */
+Array * column_array_view(ColumnArray * array, int column, Array * view);
+
+/**
+ * @brief Searches a column for an element
+ *
+ * @param compare See array_search
+ *
+ * @return The index of the first row whose field matches x, or -1 if there
+ *         is none or the parameters are invalid.
+ */
+int column_array_search(ColumnArray * array, int column, void * x, int (*compare)(void * a, void * b));
+
+/**
+ * @brief Sorts the rows by one column
+ *
+ * The keys are sorted with array_sort together with their row numbers, and
+ * then every column is rearranged once. compare is called with pointers to
+ * fields of the key column, as for array_sort. The sort is not stable.
+ *
+ * @return 0 on success, 1 otherwise, in which case the rows are unchanged.
+ */
+int column_array_sort(ColumnArray * array, int column, int (*compare)(void * a, void * b));
+
+/**
+ * @brief Finds the row holding the k-th smallest field of a column
+ *
+ * It uses quickselect, expected O(n), and leaves the rows in place.
+ *
+ * @param k Rank looked for, 0 being the smallest
+ *
+ * @return The index of the row, or -1 if k is out of range or on error.
+ */
+int column_array_select(ColumnArray * array, int column, int k, int (*compare)(void * a, void * b));
+
+/**
+ * @brief Pointer to the field of a row in a column
+ */
+#define column_array_at(array, column, row) \
+    ((void *) ((char *) (array)->columns[(column)] + (size_t) (row) * (array)->widths[(column)]))
+
+#define column_array_num_elem(array) ((array)->num_elem)
+
+#endif
@@ -0,0 +1,283 @@
+#include "conc_dlist.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+#define CONC_DLIST_ALLOCATION_ERROR "Memory allocation error for the concurrent list\n"
+
+#define NULL_CONC_DLIST_POINTER "Concurrent list pointer is null\n"
+
+#define NULL_COMPARE_POINTER "Param compare is null\n"
+
+#define NULL_RECORD_POINTER "Epoch record pointer is null\n"
+
+#define NULL_VISIT_POINTER "Null pointer for visit parameter\n"
+
+static ConcDlistNode * node_alloc(void * data, int sentinel) {
+    ConcDlistNode * node = malloc(sizeof(ConcDlistNode));
+    if (!node) {
+        fputs(CONC_DLIST_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    node->data = data;
+    atomic_init(&node->next, NULL);
+    atomic_init(&node->prev, NULL);
+    atomic_init(&node->marked, 0);
+    node->sentinel = sentinel;
+    pthread_mutex_init(&node->lock, NULL);
+    return node;
+}
+
+static void node_free(ConcDlist * list, ConcDlistNode * node) {
+    if (list->destroy && !node->sentinel)
+        list->destroy(node->data);
+    pthread_mutex_destroy(&node->lock);
+    free(node);
+}
+
+/* Releases a retired node once no thread can reach it */
+static void node_reclaim(void * ptr, void * ctx) {
+    node_free(ctx, ptr);
+}
+
+ConcDlist * conc_dlist_init(int (*compare)(void * a, void * b), void (*destroy)(void * data)) {
+    if (!compare) {
+        fputs(NULL_COMPARE_POINTER, stderr);
+        return NULL;
+    }
+
+    ConcDlist * list = malloc(sizeof(ConcDlist));
+    if (!list) {
+        fputs(CONC_DLIST_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    list->head = node_alloc(NULL, -1);
+    list->tail = node_alloc(NULL, 1);
+    list->domain = epoch_init();
+
+    if (!list->head || !list->tail || !list->domain) {
+        if (list->head) node_free(list, list->head);
+        if (list->tail) node_free(list, list->tail);
+        if (list->domain) epoch_terminate(list->domain);
+        free(list);
+        return NULL;
+    }
+
+    atomic_init(&list->head->next, list->tail);
+    atomic_init(&list->tail->prev, list->head);
+    atomic_init(&list->num_elem, 0);
+    list->compare = compare;
+    list->destroy = destroy;
+
+    return list;
+}
+
+void conc_dlist_terminate(ConcDlist * list) {
+    if (!list) {
+        fputs(NULL_CONC_DLIST_POINTER, stderr);
+        return;
+    }
+
+    /* Removed nodes first: their reclaim callbacks use the list */
+    epoch_terminate(list->domain);
+
+    ConcDlistNode * node = list->head;
+    while (node) {
+        ConcDlistNode * next = atomic_load_explicit(&node->next, memory_order_relaxed);
+        node_free(list, node);
+        node = next;
+    }
+
+    free(list);
+}
+
+EpochRecord * conc_dlist_register(ConcDlist * list) {
+    if (!list) {
+        fputs(NULL_CONC_DLIST_POINTER, stderr);
+        return NULL;
+    }
+    return epoch_register(list->domain);
+}
+
+void conc_dlist_unregister(ConcDlist * list, EpochRecord * record) {
+    if (!list) {
+        fputs(NULL_CONC_DLIST_POINTER, stderr);
+        return;
+    }
+    epoch_unregister(list->domain, record);
+}
+
+/* Compares a node with x, sentinels being smaller and greater than anything */
+static int node_compare(ConcDlist * list, ConcDlistNode * node, void * x) {
+    if (node->sentinel)
+        return node->sentinel;
+    return list->compare(node->data, x);
+}
+
+/* Walks, without locks, to the first node not smaller than x and its
+ * predecessor. Must be called from inside a critical section. */
+static void locate(ConcDlist * list, void * x, ConcDlistNode ** pred, ConcDlistNode ** curr) {
+    ConcDlistNode * p = list->head;
+    ConcDlistNode * c = atomic_load_explicit(&p->next, memory_order_acquire);
+
+    while (node_compare(list, c, x) < 0) {
+        p = c;
+        c = atomic_load_explicit(&c->next, memory_order_acquire);
+    }
+
+    *pred = p;
+    *curr = c;
+}
+
+/* Both nodes still linked and adjacent. Must be called with both locked. */
+static int validate(ConcDlistNode * pred, ConcDlistNode * curr) {
+    return !atomic_load_explicit(&pred->marked, memory_order_relaxed)
+        && !atomic_load_explicit(&curr->marked, memory_order_relaxed)
+        && atomic_load_explicit(&pred->next, memory_order_relaxed) == curr;
+}
+
+static int check_args(ConcDlist * list, EpochRecord * record) {
+    if (!list) {
+        fputs(NULL_CONC_DLIST_POINTER, stderr);
+        return 1;
+    } else if (!record) {
+        fputs(NULL_RECORD_POINTER, stderr);
+        return 1;
+    }
+    return 0;
+}
+
+int conc_dlist_insert(ConcDlist * list, EpochRecord * record, void * data) {
+    if (check_args(list, record))
+        return 1;
+
+    ConcDlistNode * node = node_alloc(data, 0);
+    if (!node)
+        return 1;
+
+    for (;;) {
+        ConcDlistNode * pred, * curr;
+
+        epoch_enter(list->domain, record);
+        locate(list, data, &pred, &curr);
+
+        pthread_mutex_lock(&pred->lock);
+        pthread_mutex_lock(&curr->lock);
+
+        if (!validate(pred, curr)) {
+            pthread_mutex_unlock(&curr->lock);
+            pthread_mutex_unlock(&pred->lock);
+            epoch_exit(record);
+            continue;
+        }
+
+        int present = node_compare(list, curr, data) == 0;
+
+        if (!present) {
+            atomic_init(&node->next, curr);
+            atomic_init(&node->prev, pred);
+            /* curr->prev is only written under the lock of its predecessor */
+            atomic_store_explicit(&curr->prev, node, memory_order_release);
+            atomic_store_explicit(&pred->next, node, memory_order_release);
+            atomic_fetch_add_explicit(&list->num_elem, 1, memory_order_relaxed);
+        }
+
+        pthread_mutex_unlock(&curr->lock);
+        pthread_mutex_unlock(&pred->lock);
+        epoch_exit(record);
+
+        if (present) {
+            /* Never published, so it can go right away without its data */
+            pthread_mutex_destroy(&node->lock);
+            free(node);
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int conc_dlist_remove(ConcDlist * list, EpochRecord * record, void * x) {
+    if (check_args(list, record))
+        return 1;
+
+    for (;;) {
+        ConcDlistNode * pred, * curr;
+
+        epoch_enter(list->domain, record);
+        locate(list, x, &pred, &curr);
+
+        pthread_mutex_lock(&pred->lock);
+        pthread_mutex_lock(&curr->lock);
+
+        if (!validate(pred, curr)) {
+            pthread_mutex_unlock(&curr->lock);
+            pthread_mutex_unlock(&pred->lock);
+            epoch_exit(record);
+            continue;
+        }
+
+        int found = node_compare(list, curr, x) == 0;
+
+        if (found) {
+            /* Logical deletion first, so lookups skip it from now on */
+            atomic_store_explicit(&curr->marked, 1, memory_order_release);
+
+            /* Holding curr's lock keeps its successor linked, and only the
+             * holder of that lock writes the successor's prev */
+            ConcDlistNode * succ = atomic_load_explicit(&curr->next, memory_order_relaxed);
+            atomic_store_explicit(&succ->prev, pred, memory_order_release);
+            atomic_store_explicit(&pred->next, succ, memory_order_release);
+            atomic_fetch_sub_explicit(&list->num_elem, 1, memory_order_relaxed);
+        }
+
+        pthread_mutex_unlock(&curr->lock);
+        pthread_mutex_unlock(&pred->lock);
+        epoch_exit(record);
+
+        if (!found)
+            return 1;
+
+        if (epoch_retire(list->domain, curr, node_reclaim, list)) {
+            /* Can't defer it: wait for the other threads and free it here */
+            epoch_barrier(list->domain);
+            node_free(list, curr);
+        }
+        return 0;
+    }
+}
+
+int conc_dlist_contains(ConcDlist * list, EpochRecord * record, void * x) {
+    if (check_args(list, record))
+        return 0;
+
+    ConcDlistNode * pred, * curr;
+
+    epoch_enter(list->domain, record);
+    locate(list, x, &pred, &curr);
+    int found = node_compare(list, curr, x) == 0
+                && !atomic_load_explicit(&curr->marked, memory_order_acquire);
+    epoch_exit(record);
+
+    return found;
+}
+
+void conc_dlist_for_each(ConcDlist * list, EpochRecord * record, void (*visit)(void * data, void * ctx), void * ctx) {
+    if (check_args(list, record))
+        return;
+    else if (!visit) {
+        fputs(NULL_VISIT_POINTER, stderr);
+        return;
+    }
+
+    epoch_enter(list->domain, record);
+
+    ConcDlistNode * node = atomic_load_explicit(&list->head->next, memory_order_acquire);
+    while (node != list->tail) {
+        if (!atomic_load_explicit(&node->marked, memory_order_acquire))
+            visit(node->data, ctx);
+        node = atomic_load_explicit(&node->next, memory_order_acquire);
+    }
+
+    epoch_exit(record);
+}
@@ -0,0 +1,139 @@
+#ifndef CONC_DLIST_H
+#define CONC_DLIST_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "epoch.h"
+
+/**
+ * @file conc_dlist.h
+ * @brief Concurrent sorted doubly linked list with fine grained locking.
+ *
+ * The list keeps its elements sorted by a compare function, without
+ * duplicates, and lets many threads insert and remove at the same time. It
+ * follows the lazy list algorithm:
+ *
+ *  - Traversals take no locks. A thread walks to the place of interest and
+ *    only then locks the two nodes around it, left to right.
+ *  - After locking, it validates that both nodes are still linked and still
+ *    adjacent. If not, another thread got in between and it starts over.
+ *  - A removal first marks the node as logically deleted and then unlinks it,
+ *    so lookups can ignore a node as soon as it's marked.
+ *
+ * Operations on different parts of the list lock different nodes and run in
+ * parallel. Lookups never lock nor retry.
+ *
+ * Unlinked nodes are retired to an epoch domain and freed, along with their
+ * data through destroy, once no thread can be walking over them. That's why
+ * every thread using the list registers once with conc_dlist_register and
+ * gives its record to each operation.
+ *
+ * The prev pointers are kept up to date under the same locks, but a thread
+ * walking backwards without locks may see an element just removed.
+ */
+
+/**
+ * @brief A node of the list
+ */
+typedef struct ConcDlistNode {
+    void * data;                            /**< Pointer to the data, unused in sentinels. */
+    _Atomic(struct ConcDlistNode *) next;   /**< Next node, NULL in the tail sentinel. */
+    _Atomic(struct ConcDlistNode *) prev;   /**< Previous node, NULL in the head sentinel. */
+    atomic_int marked;                      /**< Set once the node is logically deleted. */
+    int sentinel;                           /**< -1 for the head, 1 for the tail, 0 otherwise. */
+    pthread_mutex_t lock;                   /**< Guards the link to the next node. */
+} ConcDlistNode;
+
+/**
+ * @brief The concurrent sorted list structure
+ */
+typedef struct ConcDlist {
+    ConcDlistNode * head;                   /**< Sentinel before the smallest element. */
+    ConcDlistNode * tail;                   /**< Sentinel after the largest element. */
+    atomic_int num_elem;                    /**< Number of elements in the list. */
+    int (*compare)(void * a, void * b);     /**< Order of the elements. */
+    void (*destroy)(void * data);           /**< Element destructor, or NULL. */
+    EpochDomain * domain;                   /**< Reclamation domain of the removed nodes. */
+} ConcDlist;
+
+/**
+ * @brief Initializes a new concurrent sorted list
+ *
+ * @param compare Function ordering the elements, see list_search.
+ *
+ * @param destroy Function used to free removed elements, or NULL.
+ *
+ * @return A pointer to the new list, or NULL on error.
+ */
+ConcDlist * conc_dlist_init(int (*compare)(void * a, void * b), void (*destroy)(void * data));
+
+/**
+ * @brief Destroys the list and every element left
+ *
+ * No other thread may be using the list, and every record must be unregistered.
+ *
+ * @param list Pointer to the list
+ */
+void conc_dlist_terminate(ConcDlist * list);
+
+/**
+ * @brief Registers the calling thread
+ *
+ * @return The record of the thread, or NULL on error.
+ */
+EpochRecord * conc_dlist_register(ConcDlist * list);
+
+/**
+ * @brief Unregisters a thread
+ */
+void conc_dlist_unregister(ConcDlist * list, EpochRecord * record);
+
+/**
+ * @brief Inserts an element in order
+ *
+ * @param list Pointer to the list
+ *
+ * @param record Record of the calling thread
+ *
+ * @param data Pointer to the data to be inserted
+ *
+ * @return 0 if it was inserted, 1 if an equal element is already in the list
+ *         or on error.
+ */
+int conc_dlist_insert(ConcDlist * list, EpochRecord * record, void * data);
+
+/**
+ * @brief Removes the element equal to x
+ *
+ * The element is destroyed once no thread can reach it anymore.
+ *
+ * @return 0 if it was removed, 1 if there is no such element or on error.
+ */
+int conc_dlist_remove(ConcDlist * list, EpochRecord * record, void * x);
+
+/**
+ * @brief Whether an element equal to x is in the list
+ *
+ * It takes no locks and never retries.
+ *
+ * @return 1 if there is one, 0 otherwise.
+ */
+int conc_dlist_contains(ConcDlist * list, EpochRecord * record, void * x);
+
+/**
+ * @brief Calls visit on every element in order
+ *
+ * Elements inserted or removed during the walk may or may not be visited.
+ *
+ * @param visit Function called as visit(data, ctx)
+ *
+ * @param ctx User context given to visit
+ */
+void conc_dlist_for_each(ConcDlist * list, EpochRecord * record, void (*visit)(void * data, void * ctx), void * ctx);
+
+/**
+ * @brief Number of elements in the list
+ */
+#define conc_dlist_num_elem(list) atomic_load_explicit(&(list)->num_elem, memory_order_relaxed)
+
+#endif
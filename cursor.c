@@ -0,0 +1,205 @@
+#include "cursor.h"
+#include <stdio.h>
+
+#define NULL_CURSOR_POINTER "Cursor pointer parameter is NULL\n"
+
+#define NULL_CONTAINER_POINTER "Container pointer parameter is NULL\n"
+
+#define NULL_CALLBACK_POINTER "Callback pointer parameter is NULL\n"
+
+#define CURSOR_ALLOCATION_ERROR "Memory allocation error for the filtered elements\n"
+
+/* Next node of a list node, whatever the list type */
+static void * node_next(const Cursor * cursor, void * node) {
+    if (cursor->kind == CURSOR_LIST)
+        return ((ListNode *) node)->next;
+    return ((DlistNode *) node)->next;
+}
+
+static void * node_data(const Cursor * cursor, void * node) {
+    if (cursor->kind == CURSOR_LIST)
+        return ((ListNode *) node)->data;
+    return ((DlistNode *) node)->data;
+}
+
+/* Moves the lookahead pointer one node further and prefetches it */
+static void advance_ahead(Cursor * cursor) {
+    if (cursor->ahead != cursor->end) {
+        cursor->ahead = node_next(cursor, cursor->ahead);
+        if (cursor->ahead != cursor->end)
+            __builtin_prefetch(cursor->ahead, 0, 1);
+    }
+}
+
+static void start_nodes(Cursor * cursor, CursorKind kind, void * first, void * end) {
+    cursor->kind = kind;
+    cursor->pos = cursor->ahead = first;
+    cursor->end = end;
+    cursor->step = 0;
+
+    if (first != end)
+        __builtin_prefetch(first, 0, 1);
+    for (int i = 0; i < CURSOR_PREFETCH_DISTANCE; i++)
+        advance_ahead(cursor);
+}
+
+void cursor_list(Cursor * cursor, List * list) {
+    if (!cursor) {
+        fputs(NULL_CURSOR_POINTER, stderr);
+        return;
+    } else if (!list) {
+        fputs(NULL_CONTAINER_POINTER, stderr);
+        return;
+    }
+
+    start_nodes(cursor, CURSOR_LIST, list_head(list)->next, NULL);
+}
+
+void cursor_dlist(Cursor * cursor, Dlist * dlist) {
+    if (!cursor) {
+        fputs(NULL_CURSOR_POINTER, stderr);
+        return;
+    } else if (!dlist) {
+        fputs(NULL_CONTAINER_POINTER, stderr);
+        return;
+    }
+
+    start_nodes(cursor, CURSOR_DLIST, dlist_head(dlist)->next, dlist_head(dlist));
+}
+
+void cursor_array(Cursor * cursor, Array * array) {
+    if (!cursor) {
+        fputs(NULL_CURSOR_POINTER, stderr);
+        return;
+    } else if (!array) {
+        fputs(NULL_CONTAINER_POINTER, stderr);
+        return;
+    }
+
+    cursor->kind = CURSOR_ARRAY;
+    cursor->pos = cursor->ahead = array->list;
+    cursor->end = (char *) array->list + (size_t) array->num_elem * array->elem_size;
+    cursor->step = array->elem_size;
+}
+
+int cursor_next_batch(Cursor * cursor, void ** items, int max) {
+    if (!cursor || !items) {
+        fputs(NULL_CURSOR_POINTER, stderr);
+        return 0;
+    }
+
+    int n = 0;
+
+    if (cursor->kind == CURSOR_ARRAY) {
+        char * pos = cursor->pos, * end = cursor->end;
+        size_t ahead = CURSOR_PREFETCH_DISTANCE * CURSOR_BATCH_SIZE * cursor->step;
+
+        /* Sequential, so the hardware prefetcher does most of the job; this
+         * only warms up the start of a later batch */
+        if ((size_t) (end - pos) > ahead)
+            __builtin_prefetch(pos + ahead, 0, 1);
+
+        for (; n < max && pos != end; n++, pos += cursor->step)
+            items[n] = pos;
+
+        cursor->pos = pos;
+        return n;
+    }
+
+    while (n < max && cursor->pos != cursor->end) {
+        void * data = node_data(cursor, cursor->pos);
+
+        if (data)
+            __builtin_prefetch(data, 0, 1);
+        items[n++] = data;
+
+        cursor->pos = node_next(cursor, cursor->pos);
+        advance_ahead(cursor);
+    }
+    return n;
+}
+
+void * cursor_next(Cursor * cursor) {
+    void * item;
+    return cursor_next_batch(cursor, &item, 1) ? item : NULL;
+}
+
+int cursor_for_each(Cursor * cursor, void (*visit)(void ** items, int n, void * ctx), void * ctx) {
+    if (!cursor) {
+        fputs(NULL_CURSOR_POINTER, stderr);
+        return 1;
+    } else if (!visit) {
+        fputs(NULL_CALLBACK_POINTER, stderr);
+        return 1;
+    }
+
+    void * items[CURSOR_BATCH_SIZE];
+    int n;
+
+    while ((n = cursor_next_batch(cursor, items, CURSOR_BATCH_SIZE)) > 0)
+        visit(items, n, ctx);
+
+    return 0;
+}
+
+List * cursor_filter(Cursor * cursor, int (*keep)(void ** items, int n, void * ctx), void * ctx) {
+    if (!cursor) {
+        fputs(NULL_CURSOR_POINTER, stderr);
+        return NULL;
+    } else if (!keep) {
+        fputs(NULL_CALLBACK_POINTER, stderr);
+        return NULL;
+    }
+
+    /* The kept elements are gathered first, so the list gets all its nodes in
+     * one block instead of one small block per batch */
+    int num_kept = 0, capacity = 4 * CURSOR_BATCH_SIZE;
+    void ** kept = malloc(capacity * sizeof(void *));
+    if (!kept) {
+        fputs(CURSOR_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    int n;
+    while ((n = cursor_next_batch(cursor, kept + num_kept, CURSOR_BATCH_SIZE)) > 0) {
+        num_kept += keep(kept + num_kept, n, ctx);
+
+        if (capacity - num_kept < CURSOR_BATCH_SIZE) {
+            void ** larger = realloc(kept, 2 * capacity * sizeof(void *));
+            if (!larger) {
+                fputs(CURSOR_ALLOCATION_ERROR, stderr);
+                free(kept);
+                return NULL;
+            }
+            kept = larger;
+            capacity *= 2;
+        }
+    }
+
+    List * list = list_init(NULL);
+    if (list && list_append_n(list, kept, num_kept)) {
+        list_terminate(list);
+        list = NULL;
+    }
+
+    free(kept);
+    return list;
+}
+
+int cursor_fold(Cursor * cursor, void * acc, void (*fold)(void * acc, void ** items, int n)) {
+    if (!cursor) {
+        fputs(NULL_CURSOR_POINTER, stderr);
+        return 1;
+    } else if (!fold) {
+        fputs(NULL_CALLBACK_POINTER, stderr);
+        return 1;
+    }
+
+    void * items[CURSOR_BATCH_SIZE];
+    int n;
+
+    while ((n = cursor_next_batch(cursor, items, CURSOR_BATCH_SIZE)) > 0)
+        fold(acc, items, n);
+
+    return 0;
+}
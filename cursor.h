@@ -0,0 +1,146 @@
+#ifndef CURSOR_H
+#define CURSOR_H
+
+#include "array.h"
+#include "linked_list.h"
+#include "dlist.h"
+
+/**
+ * @file cursor.h
+ * @brief Cursors for walking over List, Dlist and Array elements.
+ *
+ * A cursor hands out the elements of a container from first to last, either
+ * one at a time or in batches. For lists the elements are the data pointers of
+ * the nodes; for arrays they are pointers to the elements inside the array.
+ *
+ * While walking a list, a second pointer runs CURSOR_PREFETCH_DISTANCE nodes
+ * ahead of the cursor and prefetches every node it reaches, so the cache misses
+ * of the next nodes overlap with the work done on the current ones. The data a
+ * node points to is prefetched too, when its node is put in a batch.
+ *
+ * The for_each, filter and fold helpers deliver the elements to their callback
+ * in batches of up to CURSOR_BATCH_SIZE, which saves one indirect call per
+ * element and lets the callback work on several elements at once.
+ *
+ * A cursor is invalidated by any insertion or removal in its container.
+ */
+
+/**
+ * @brief Maximum number of elements given to a callback at once
+ */
+#define CURSOR_BATCH_SIZE 16
+
+/**
+ * @brief How many nodes ahead of the cursor are prefetched
+ */
+#define CURSOR_PREFETCH_DISTANCE 8
+
+typedef enum CursorKind {
+    CURSOR_LIST,
+    CURSOR_DLIST,
+    CURSOR_ARRAY
+} CursorKind;
+
+/**
+ * @brief The cursor structure
+ */
+typedef struct Cursor {
+    CursorKind kind;                //type of the container walked
+    void * pos;                     //next node or element to hand out
+    void * ahead;                   //node being prefetched, ahead of pos
+    void * end;                     //stop mark: NULL, the Dlist head or past the last element
+    size_t step;                    //elem_size when walking an Array
+} Cursor;
+
+/**
+ * @brief Places a cursor on the first element of a List
+ *
+ * @param cursor Pointer to the cursor
+ *
+ * @param list Pointer to the list
+ */
+void cursor_list(Cursor * cursor, List * list);
+
+/**
+ * @brief Places a cursor on the first element of a Dlist
+ */
+void cursor_dlist(Cursor * cursor, Dlist * dlist);
+
+/**
+ * @brief Places a cursor on the first element of an Array
+ */
+void cursor_array(Cursor * cursor, Array * array);
+
+/**
+ * @brief Returns the next element and advances the cursor
+ *
+ * @param cursor Pointer to the cursor
+ *
+ * @return The next element, or NULL when the cursor is past the last one.
+ *         Note that list elements may be NULL themselves; use cursor_done to
+ *         tell them apart.
+ */
+void * cursor_next(Cursor * cursor);
+
+/**
+ * @brief Fetches up to max next elements and advances the cursor past them
+ *
+ * @param cursor Pointer to the cursor
+ *
+ * @param items Buffer receiving the elements
+ *
+ * @param max Capacity of items
+ *
+ * @return The number of elements stored in items, 0 once the walk is over.
+ */
+int cursor_next_batch(Cursor * cursor, void ** items, int max);
+
+/**
+ * @brief Calls visit on every element left, in batches
+ *
+ * @param cursor Pointer to the cursor
+ *
+ * @param visit Function receiving each batch: visit(items, n, ctx)
+ *
+ * @param ctx User context given to visit
+ *
+ * @return 0 on success, 1 if a parameter is NULL.
+ */
+int cursor_for_each(Cursor * cursor, void (*visit)(void ** items, int n, void * ctx), void * ctx);
+
+/**
+ * @brief Collects the elements left that pass a filter into a new List
+ *
+ * The filter receives each batch and moves the elements it keeps to the front
+ * of items, in order, returning how many they are. The new list holds the same
+ * data pointers as the container and has no destroy function.
+ *
+ * @param cursor Pointer to the cursor
+ *
+ * @param keep Filter function: keep(items, n, ctx), returning the number kept
+ *
+ * @param ctx User context given to keep
+ *
+ * @return A pointer to the new List, or NULL on error.
+ */
+List * cursor_filter(Cursor * cursor, int (*keep)(void ** items, int n, void * ctx), void * ctx);
+
+/**
+ * @brief Folds the elements left into an accumulator, in batches
+ *
+ * @param cursor Pointer to the cursor
+ *
+ * @param acc Accumulator, updated in place
+ *
+ * @param fold Function folding a batch into the accumulator: fold(acc, items, n)
+ *
+ * @return 0 on success, 1 if a parameter is NULL.
+ */
+int cursor_fold(Cursor * cursor, void * acc, void (*fold)(void * acc, void ** items, int n));
+
+/**
+ * @brief Whether the cursor is past the last element
+ */
+#define cursor_done(cursor) ((cursor)->pos == (cursor)->end)
+
+#endif
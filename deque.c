@@ -0,0 +1,252 @@
+#include "deque.h"
+#include <stdio.h>
+#include <string.h>
+
+#define DEQUE_ALLOCATION_ERROR "Memory allocation error for the deque"
+
+#define DEQUE_CHUNK_ALLOCATION_ERROR "Memory allocation error for a deque chunk"
+
+#define DEQUE_NULL_POINTER "Deque pointer parameter is NULL"
+
+#define DEQUE_NULL_DATA "Data pointer parameter is NULL"
+
+/* Chunks aim at this many bytes, with at least DEQUE_MIN_CHUNK_ELEMS elements */
+#define DEQUE_CHUNK_BYTES 4096
+
+#define DEQUE_MIN_CHUNK_ELEMS 16
+
+#define DEQUE_INITIAL_MAP_SIZE 8
+
+#define CHUNK_LEN(deque) (1 << (deque)->chunk_shift)
+
+#define MAP_SLOT(deque, i) (((deque)->first_chunk + (i)) & ((deque)->map_size - 1))
+
+Deque * deque_init(void (*destroy)(void * data), size_t elem_size) {
+    if (elem_size == 0) {
+        fputs(DEQUE_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    Deque * deque = malloc(sizeof(Deque));
+    if (!deque) {
+        fputs(DEQUE_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    deque->chunks = malloc(DEQUE_INITIAL_MAP_SIZE * sizeof(void *));
+    if (!deque->chunks) {
+        fputs(DEQUE_ALLOCATION_ERROR, stderr);
+        free(deque);
+        return NULL;
+    }
+
+    int shift = 0;
+    while (((size_t) 2 << shift) * elem_size <= DEQUE_CHUNK_BYTES)
+        shift++;
+    while ((1 << shift) < DEQUE_MIN_CHUNK_ELEMS)
+        shift++;
+
+    deque->map_size = DEQUE_INITIAL_MAP_SIZE;
+    deque->first_chunk = 0;
+    deque->num_chunks = 0;
+    deque->front = 0;
+    deque->num_elem = 0;
+    deque->chunk_shift = shift;
+    deque->elem_size = elem_size;
+    deque->spare = NULL;
+    deque->destroy = destroy;
+
+    return deque;
+}
+
+void deque_terminate(Deque * deque) {
+    if (!deque) {
+        fputs(DEQUE_NULL_POINTER, stderr);
+        return;
+    }
+
+    if (deque->destroy)
+        for (int i = 0; i < deque->num_elem; i++)
+            deque->destroy(deque_at(deque, i));
+
+    for (int i = 0; i < deque->num_chunks; i++)
+        free(deque->chunks[MAP_SLOT(deque, i)]);
+
+    free(deque->spare);
+    free(deque->chunks);
+    free(deque);
+}
+
+static void * take_chunk(Deque * deque) {
+    void * chunk = deque->spare;
+
+    if (chunk) {
+        deque->spare = NULL;
+        return chunk;
+    }
+
+    chunk = malloc((size_t) CHUNK_LEN(deque) * deque->elem_size);
+    if (!chunk)
+        fputs(DEQUE_CHUNK_ALLOCATION_ERROR, stderr);
+    return chunk;
+}
+
+static void give_back_chunk(Deque * deque, void * chunk) {
+    if (!deque->spare)
+        deque->spare = chunk;
+    else
+        free(chunk);
+}
+
+/* Makes room for one more chunk in the ring, unrolling it to start at 0 */
+static int reserve_chunk_slot(Deque * deque) {
+    if (deque->num_chunks < deque->map_size)
+        return 0;
+
+    int map_size = deque->map_size * 2;
+    void ** chunks = malloc(map_size * sizeof(void *));
+    if (!chunks) {
+        fputs(DEQUE_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    for (int i = 0; i < deque->num_chunks; i++)
+        chunks[i] = deque->chunks[MAP_SLOT(deque, i)];
+
+    free(deque->chunks);
+    deque->chunks = chunks;
+    deque->map_size = map_size;
+    deque->first_chunk = 0;
+    return 0;
+}
+
+/* Pointer to the element at absolute position pos, counted from the start
+ * of the first chunk */
+static void * slot_at(Deque * deque, int pos) {
+    char * chunk = deque->chunks[MAP_SLOT(deque, pos >> deque->chunk_shift)];
+    return chunk + (size_t) (pos & (CHUNK_LEN(deque) - 1)) * deque->elem_size;
+}
+
+/* Hands every chunk back once the deque gets empty */
+static void release_all_chunks(Deque * deque) {
+    for (int i = 0; i < deque->num_chunks; i++)
+        give_back_chunk(deque, deque->chunks[MAP_SLOT(deque, i)]);
+    deque->num_chunks = 0;
+    deque->first_chunk = 0;
+    deque->front = 0;
+}
+
+int deque_push_back(Deque * deque, void * data) {
+    if (!deque) {
+        fputs(DEQUE_NULL_POINTER, stderr);
+        return 1;
+    } else if (!data) {
+        fputs(DEQUE_NULL_DATA, stderr);
+        return 1;
+    }
+
+    int pos = deque->front + deque->num_elem;
+
+    if ((pos >> deque->chunk_shift) == deque->num_chunks) {
+        if (reserve_chunk_slot(deque))
+            return 1;
+        void * chunk = take_chunk(deque);
+        if (!chunk)
+            return 1;
+        deque->chunks[MAP_SLOT(deque, deque->num_chunks)] = chunk;
+        deque->num_chunks++;
+    }
+
+    memcpy(slot_at(deque, pos), data, deque->elem_size);
+    deque->num_elem++;
+    return 0;
+}
+
+int deque_push_front(Deque * deque, void * data) {
+    if (!deque) {
+        fputs(DEQUE_NULL_POINTER, stderr);
+        return 1;
+    } else if (!data) {
+        fputs(DEQUE_NULL_DATA, stderr);
+        return 1;
+    }
+
+    if (deque->front == 0) {
+        if (reserve_chunk_slot(deque))
+            return 1;
+        void * chunk = take_chunk(deque);
+        if (!chunk)
+            return 1;
+        deque->first_chunk = (deque->first_chunk - 1) & (deque->map_size - 1);
+        deque->chunks[deque->first_chunk] = chunk;
+        deque->num_chunks++;
+        deque->front = CHUNK_LEN(deque);
+    }
+
+    deque->front--;
+    memcpy(slot_at(deque, deque->front), data, deque->elem_size);
+    deque->num_elem++;
+    return 0;
+}
+
+static void take_out(Deque * deque, void * elem, void * out) {
+    if (out)
+        memcpy(out, elem, deque->elem_size);
+    else if (deque->destroy)
+        deque->destroy(elem);
+}
+
+int deque_pop_back(Deque * deque, void * out) {
+    if (!deque) {
+        fputs(DEQUE_NULL_POINTER, stderr);
+        return 1;
+    } else if (deque->num_elem == 0) {
+        return 1;
+    }
+
+    deque->num_elem--;
+    int pos = deque->front + deque->num_elem;
+    take_out(deque, slot_at(deque, pos), out);
+
+    if (deque->num_elem == 0) {
+        release_all_chunks(deque);
+    } else if ((pos & (CHUNK_LEN(deque) - 1)) == 0) {
+        deque->num_chunks--;
+        give_back_chunk(deque, deque->chunks[MAP_SLOT(deque, deque->num_chunks)]);
+    }
+    return 0;
+}
+
+int deque_pop_front(Deque * deque, void * out) {
+    if (!deque) {
+        fputs(DEQUE_NULL_POINTER, stderr);
+        return 1;
+    } else if (deque->num_elem == 0) {
+        return 1;
+    }
+
+    take_out(deque, slot_at(deque, deque->front), out);
+    deque->front++;
+    deque->num_elem--;
+
+    if (deque->num_elem == 0) {
+        release_all_chunks(deque);
+    } else if (deque->front == CHUNK_LEN(deque)) {
+        give_back_chunk(deque, deque->chunks[deque->first_chunk]);
+        deque->first_chunk = MAP_SLOT(deque, 1);
+        deque->num_chunks--;
+        deque->front = 0;
+    }
+    return 0;
+}
+
+void * deque_at(Deque * deque, int index) {
+    if (!deque) {
+        fputs(DEQUE_NULL_POINTER, stderr);
+        return NULL;
+    } else if (index < 0 || index >= deque->num_elem) {
+        return NULL;
+    }
+
+    return slot_at(deque, deque->front + index);
+}
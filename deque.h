@@ -0,0 +1,126 @@
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include <stdlib.h>
+
+/**
+ * @file deque.h
+ * @brief Double ended queue stored in fixed size chunks.
+ *
+ * Elements are stored inline, like in Array, at elem_size stride inside chunks
+ * of a fixed number of elements. The chunks are referenced by a ring of chunk
+ * pointers, so elements can be pushed and popped at both ends in O(1) without
+ * shifting the other ones, and any element can be reached by index in O(1).
+ *
+ * A chunk emptied by a pop is kept as a spare and reused by the next push that
+ * needs a new chunk, so a deque oscillating around a chunk boundary doesn't
+ * keep allocating and freeing memory.
+ *
+ * Pointers returned by deque_at stay valid until that element is popped, since
+ * elements never move between chunks.
+ */
+
+/**
+ * @brief The deque structure
+ */
+typedef struct Deque {
+    void ** chunks;                 //ring of chunk pointers
+    int map_size;                   //capacity of the ring, always a power of two
+    int first_chunk;                //ring index of the chunk holding the first element
+    int num_chunks;                 //number of chunks in use
+    int front;                      //offset of the first element inside its chunk
+    int num_elem;                   //number of elements in the deque
+    int chunk_shift;                //log2 of the number of elements per chunk
+    size_t elem_size;               //length in bytes of one single element
+    void * spare;                   //an empty chunk kept for reuse, or NULL
+    void (*destroy)(void * data);   //funtion pointer for elements cleaning up routine
+} Deque;
+
+/**
+ * @brief Initializes a new Deque
+ *
+ * @param destroy A pointer to funtion that will be used to clean up elements
+ *                popped without an output buffer and elements left when the
+ *                deque is terminated. It receives a pointer to the element
+ *                inside the deque. Can be NULL.
+ *
+ * @param elem_size The size in bytes of a individual element
+ *
+ * @return A pointer to a new Deque, or NULL if memory allocation fails.
+ */
+Deque * deque_init(void (*destroy)(void * data), size_t elem_size);
+
+/**
+ * @brief Destroys the deque, calling destroy on every element left
+ *
+ * @param deque Pointer to the deque
+ */
+void deque_terminate(Deque * deque);
+
+/**
+ * @brief Appends a copy of an element at the back of the deque
+ *
+ * @param deque Pointer to the deque
+ *
+ * @param data Pointer to the elem_size bytes to be copied
+ *
+ * @return 0 if the element was pushed, 1 otherwise.
+ */
+int deque_push_back(Deque * deque, void * data);
+
+/**
+ * @brief Prepends a copy of an element at the front of the deque
+ *
+ * @param deque Pointer to the deque
+ *
+ * @param data Pointer to the elem_size bytes to be copied
+ *
+ * @return 0 if the element was pushed, 1 otherwise.
+ */
+int deque_push_front(Deque * deque, void * data);
+
+/**
+ * @brief Removes the element at the back of the deque
+ *
+ * @param deque Pointer to the deque
+ *
+ * @param out Buffer where the element is copied to. If it is NULL, the
+ *            element is passed to destroy instead.
+ *
+ * @return 0 if an element was popped, 1 if the deque is empty.
+ */
+int deque_pop_back(Deque * deque, void * out);
+
+/**
+ * @brief Removes the element at the front of the deque
+ *
+ * @param deque Pointer to the deque
+ *
+ * @param out Buffer where the element is copied to. If it is NULL, the
+ *            element is passed to destroy instead.
+ *
+ * @return 0 if an element was popped, 1 if the deque is empty.
+ */
+int deque_pop_front(Deque * deque, void * out);
+
+/**
+ * @brief Accesses an element by its position
+ *
+ * @param deque Pointer to the deque
+ *
+ * @param index Position of the element, 0 being the front
+ *
+ * @return A pointer to the element inside the deque, or NULL if index is out
+ *         of range.
+ */
+void * deque_at(Deque * deque, int index);
+
+#define deque_front(deque) deque_at((deque), 0)
+
+#define deque_back(deque) deque_at((deque), (deque)->num_elem - 1)
+
+#define deque_num_elem(deque) ((deque)->num_elem)
+
+#define deque_elem_size(deque) ((deque)->elem_size)
+
+#endif
@@ -18,21 +18,43 @@
 
 #define NULL_POINTER_FOR_X "searched data is null"
 
+#define NULL_ARRAY_POINTER "Array pointer is null\n"
+
+#define NULL_REGION_POINTER "Region pointer is null\n"
+
+#define INVALID_NODE_POINTER "Invalid node to move first\n"
+
 Dlist * dlist_init(void (*destroy)(void * data)) {
+    return dlist_init_with(destroy, NULL);
+}
 
-    Dlist * dlist = malloc(sizeof(Dlist));
+Dlist * dlist_init_region(Region * region) {
+    if (!region) {
+        fputs(NULL_REGION_POINTER, stderr);
+        return NULL;
+    }
+
+    return dlist_init_with(NULL, region_allocator(region));
+}
+
+Dlist * dlist_init_with(void (*destroy)(void * data), const Allocator * allocator) {
+    allocator = allocator_or_default(allocator);
+
+    Dlist * dlist = allocator_alloc(allocator, sizeof(Dlist));
     if (!dlist) {
         fputs(DLIST_ALLOCATION_ERROR, stderr);
-        exit(1);        
+        return NULL;
     }
 
-    DlistNode * head = malloc(sizeof(DlistNode));
+    DlistNode * head = allocator_alloc(allocator, sizeof(DlistNode));
     if (!head) {
         fputs(DLIST_ALLOCATION_ERROR, stderr);
-        exit(1);
+        allocator_free(allocator, dlist);
+        return NULL;
     }
 
     head->prev = head->next = head;
+    head->block = NULL;
 
     dlist->head = head;
 
@@ -40,39 +62,187 @@ Dlist * dlist_init(void (*destroy)(void * data)) {
 
     dlist->destroy = destroy;
 
+    dlist->blocks = NULL;
+
+    dlist->heap_nodes = 0;
+
+    dlist->filter = NULL;
+
+    dlist->allocator = allocator;
+
     return dlist;
 }
 
-void dlist_insert_next(Dlist * dlist, DlistNode * prev, void * data){
-    DlistNode * newNode = malloc(sizeof(DlistNode));
+void dlist_move_first(Dlist * dlist, DlistNode * node) {
+    if (!dlist) {
+        fputs(NULL_DLIST_POINTER, stderr);
+        return;
+    } else if (!node || node == dlist_head(dlist)) {
+        fputs(INVALID_NODE_POINTER, stderr);
+        return;
+    }
+
+    DlistNode * head = dlist_head(dlist);
+
+    if (head->next == node)
+        return;
+
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+
+    node->prev = head; node->next = head->next;
+    head->next->prev = node;
+    head->next = node;
+}
+
+DlistNode * dlist_alloc_nodes(Dlist * dlist, int n) {
+    if (!dlist) {
+        fputs(NULL_DLIST_POINTER, stderr);
+        return NULL;
+    } else if (n <= 0) {
+        return NULL;
+    }
+
+    DlistNodeBlock * block = allocator_alloc(dlist->allocator, sizeof(DlistNodeBlock) + (size_t) n * sizeof(DlistNode));
+    if (!block) {
+        fputs(DLIST_NODE_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    block->num_nodes = n;
+    block->num_live = n;
+    block->prev = NULL;
+    block->next = dlist->blocks;
+    if (dlist->blocks)
+        dlist->blocks->prev = block;
+    dlist->blocks = block;
+
+    for (int i = 0; i < n; i++)
+        block->nodes[i].block = block;
+
+    return block->nodes;
+}
+
+Dlist * dlist_from_array(Array * array, void (*destroy)(void * data)) {
+    if (!array) {
+        fputs(NULL_ARRAY_POINTER, stderr);
+        return NULL;
+    }
+
+    Dlist * dlist = dlist_init(destroy);
+    int n = array->num_elem;
+
+    if (!dlist || n == 0)
+        return dlist;
+
+    DlistNode * nodes = dlist_alloc_nodes(dlist, n);
+    if (!nodes) {
+        dlist_terminate(dlist);
+        return NULL;
+    }
+
+    DlistNode * head = dlist_head(dlist);
+    char * elem = array->list;
+
+    for (int i = 0; i < n; i++, elem += array->elem_size) {
+        nodes[i].data = elem;
+        nodes[i].prev = i > 0 ? &nodes[i - 1] : head;
+        nodes[i].next = i < n - 1 ? &nodes[i + 1] : head;
+    }
+
+    head->next = &nodes[0];
+    head->prev = &nodes[n - 1];
+    dlist_num_elem(dlist) = n;
+
+    return dlist;
+}
+
+/* Frees a node allocated on its own, or the block of a node once the block
+ * has no node in use left */
+static void dlist_release_node(Dlist * dlist, DlistNode * node) {
+    DlistNodeBlock * block = node->block;
+
+    if (!block) {
+        allocator_free(dlist->allocator, node);
+        dlist->heap_nodes--;
+        return;
+    }
+
+    if (--block->num_live > 0)
+        return;
+
+    if (block->prev)
+        block->prev->next = block->next;
+    else
+        dlist->blocks = block->next;
+    if (block->next)
+        block->next->prev = block->prev;
+
+    allocator_free(dlist->allocator, block);
+}
+
+int dlist_insert_next(Dlist * dlist, DlistNode * prev, void * data){
+    if (!dlist) {
+        fputs(NULL_DLIST_POINTER, stderr);
+        return 1;
+    } else if (!prev) {
+        fputs(PREVIOUS_PARAM_NULL, stderr);
+        return 1;
+    }
+
+    DlistNode * newNode = allocator_alloc(dlist->allocator, sizeof(DlistNode));
 
     if (!newNode) {
-        fputs(DLIST_ALLOCATION_ERROR, stderr);
-        exit(1);
+        fputs(DLIST_NODE_ALLOCATION_ERROR, stderr);
+        return 1;
     }
 
     newNode->data = data;
+    newNode->block = NULL;
 
     newNode->prev = prev; newNode->next = prev->next;
+    prev->next->prev = newNode;
     prev->next = newNode;
 
     ++dlist_num_elem(dlist);
+    ++dlist->heap_nodes;
+
+    if (dlist->filter)
+        bloom_add(dlist->filter, data);
+
+    return 0;
 }
 
-void dlist_insert_prev(Dlist * dlist, DlistNode * next, void * data){
-    DlistNode * newNode = malloc(sizeof(DlistNode));
+int dlist_insert_prev(Dlist * dlist, DlistNode * next, void * data){
+    if (!dlist) {
+        fputs(NULL_DLIST_POINTER, stderr);
+        return 1;
+    } else if (!next) {
+        fputs(PREVIOUS_PARAM_NULL, stderr);
+        return 1;
+    }
+
+    DlistNode * newNode = allocator_alloc(dlist->allocator, sizeof(DlistNode));
 
     if (!newNode) {
-        fputs(DLIST_ALLOCATION_ERROR, stderr);
-        exit(1);
+        fputs(DLIST_NODE_ALLOCATION_ERROR, stderr);
+        return 1;
     }
 
     newNode->data = data;
+    newNode->block = NULL;
 
     newNode->prev = next->prev; newNode->next = next;
+    next->prev->next = newNode;
     next->prev = newNode;
 
     ++dlist_num_elem(dlist);
+    ++dlist->heap_nodes;
+
+    if (dlist->filter)
+        bloom_add(dlist->filter, data);
+
+    return 0;
 }
 
 void  delist_remove_next(Dlist * dlist, DlistNode * prev) {
@@ -99,8 +269,11 @@ void  delist_remove_next(Dlist * dlist, DlistNode * prev) {
 
     prev->next = old->next;
     old->next->prev = old->prev;
-    free(old); 
+    dlist_release_node(dlist, old);
     dlist_num_elem(dlist)--;
+
+    if (dlist->filter)
+        bloom_invalidate(dlist->filter);
 }
 
 void dlist_remove_prev(Dlist * dlist, DlistNode * next) {
@@ -126,8 +299,11 @@ void dlist_remove_prev(Dlist * dlist, DlistNode * next) {
 
     next->prev = old->prev;
     old->prev->next = next;
-    free(old);
+    dlist_release_node(dlist, old);
     dlist_num_elem(dlist)--;
+
+    if (dlist->filter)
+        bloom_invalidate(dlist->filter);
 }
 
 void dlist_terminate(Dlist * dlist) {
@@ -136,13 +312,77 @@ void dlist_terminate(Dlist * dlist) {
         return;
     }
 
-    while (dlist_num_elem(dlist) != 0) {
-        delist_remove_next(dlist, dlist_head(dlist));
+    if (dlist->filter)
+        bloom_terminate(dlist->filter);
+    dlist->filter = NULL;
+
+    /* Everything else goes away with the region */
+    if (!dlist->destroy && allocator_frees_in_bulk(dlist->allocator))
+        return;
+
+    /* Block nodes are freed with their block; walk only if there is data to
+     * destroy or nodes allocated one by one */
+    if (dlist->destroy || dlist->heap_nodes > 0) {
+        while (dlist_num_elem(dlist) != 0) {
+            delist_remove_next(dlist, dlist_head(dlist));
+        }
+    }
+
+    while (dlist->blocks != NULL) {
+        DlistNodeBlock * next = dlist->blocks->next;
+        allocator_free(dlist->allocator, dlist->blocks);
+        dlist->blocks = next;
+    }
+
+    allocator_free(dlist->allocator, dlist_head(dlist));
+    allocator_free(dlist->allocator, dlist);
+}
+
+/* Refills the filter with every element of the list */
+static int dlist_filter_fill(Dlist * dlist) {
+    if (bloom_reset(dlist->filter, 2 * dlist_num_elem(dlist)))
+        return 1;
+
+    for (DlistNode * walker = dlist_head(dlist)->next; walker != dlist_head(dlist); walker = walker->next)
+        bloom_add(dlist->filter, walker->data);
+
+    return 0;
+}
+
+/* Whether the filter can answer searches, rebuilding it first if it's stale */
+static int dlist_filter_ready(Dlist * dlist) {
+    return !bloom_stale(dlist->filter) || !dlist_filter_fill(dlist);
+}
+
+int dlist_attach_filter(Dlist * dlist, uint64_t (*hash)(void * data), double fp_rate, size_t max_bytes) {
+    if (!dlist) {
+        fputs(NULL_DLIST_POINTER, stderr);
+        return 1;
     }
-    free(dlist_head(dlist));
-    free(dlist);
+
+    Bloom * filter = bloom_init(hash, 2 * dlist_num_elem(dlist), fp_rate, max_bytes);
+    if (!filter)
+        return 1;
+
+    if (dlist->filter)
+        bloom_terminate(dlist->filter);
+    dlist->filter = filter;
+
+    /* Fresh filter of the right size: filling it can't fail */
+    dlist_filter_fill(dlist);
+    return 0;
 }
 
+void dlist_detach_filter(Dlist * dlist) {
+    if (!dlist) {
+        fputs(NULL_DLIST_POINTER, stderr);
+        return;
+    }
+
+    if (dlist->filter)
+        bloom_terminate(dlist->filter);
+    dlist->filter = NULL;
+}
 
 DlistNode * dlist_search(Dlist * dlist, void * x, int (*compare)(void * a, void * b)) {
     if (!dlist) {
@@ -156,6 +396,9 @@ DlistNode * dlist_search(Dlist * dlist, void * x, int (*compare)(void * a, void
         return NULL;
     }
     
+    if (dlist->filter && dlist_filter_ready(dlist) && !bloom_may_contain(dlist->filter, x))
+        return NULL;
+
     DlistNode * walker  = dlist_head(dlist)->next;
 
     while (walker != dlist_head(dlist)) {
@@ -2,19 +2,37 @@
 #define DLIST_H
 
 #include "linked_list.h" 
+#include "allocator.h"
+#include "region.h"
 
 // Structure representing a node in a doubly linked list.
 typedef struct DlistNode {
     void * data;              // Pointer to the data stored in the node (generic type).
     struct DlistNode * next;  // Pointer to the next node in the list.
     struct DlistNode * prev;  // Pointer to the previous node in the list.
+    struct DlistNodeBlock * block; // Block the node lives in, NULL if allocated on its own.
 } DlistNode;
 
+// Structure representing a block of nodes allocated at once. Nodes inside a block are
+// not freed one by one; the block counts the nodes still in use and is freed when the
+// last of them is removed, or when the owning list is terminated.
+typedef struct DlistNodeBlock {
+    struct DlistNodeBlock * next; // Next block owned by the same list.
+    struct DlistNodeBlock * prev; // Previous block owned by the same list.
+    int num_nodes;             // Number of nodes in the block.
+    int num_live;              // Nodes not removed from the list yet.
+    DlistNode nodes[];         // The nodes themselves.
+} DlistNodeBlock;
+
 // Structure representing a doubly linked list.
 typedef struct Dlist {
     DlistNode * head;          // Pointer to the first node of the list.
     int num_elem;              // Number of elements currently in the list.
     void (*destroy)(void * data); // Optional function pointer to free the memory of the data stored in the nodes.
+    DlistNodeBlock * blocks;   // Node blocks owned by the list, NULL if none.
+    int heap_nodes;            // Number of nodes allocated one by one, outside any block.
+    Bloom * filter;            // Optional membership filter checked by dlist_search, NULL if none.
+    const Allocator * allocator; // Allocator of the list structure and its nodes.
 } Dlist;
 
 /**
@@ -31,19 +49,43 @@ typedef struct Dlist {
  * 
  * @param destroy A function pointer to handle freeing the memory of the data (optional). If no
  *                clean up is necessary, than pass NULL as for destroy parameter.
- * @return A pointer to the newly initialized list.
+ * @return A pointer to the newly initialized list, or NULL if memory allocation fails.
  */
 Dlist * dlist_init(void (*destroy)(void * data));
 
+/**
+ * Initializes a new doubly circle linked list whose memory comes from an allocator.
+ * 
+ * The list structure, its head and all its nodes are allocated with the given allocator,
+ * which must outlive the list. See dlist_init.
+ * 
+ * @param destroy Function to free the data of the nodes, or NULL.
+ * @param allocator The allocator. NULL selects the C library one.
+ * @return A pointer to the newly initialized list, or NULL if memory allocation fails.
+ */
+Dlist * dlist_init_with(void (*destroy)(void * data), const Allocator * allocator);
+
+/**
+ * Initializes a new doubly circle linked list bound to a region.
+ * 
+ * The list and its nodes live in the region, and its elements are expected to
+ * be allocated from it too. dlist_terminate then only releases the filter,
+ * without walking the nodes, and region_terminate frees the rest.
+ * 
+ * @param region The region, which must outlive the list.
+ * @return A pointer to the newly initialized list, or NULL if memory allocation fails.
+ */
+Dlist * dlist_init_region(Region * region);
+
 /**
  * Inserts a new node after a given node.
  * 
  * @param dlist Pointer to the doubly linked list.
  * @param prev The node after which the new node will be inserted. Can be NULL to insert at the head.
  * @param data Pointer to the data to store in the new node.
- * @return A pointer to the inserted data, or NULL if the operation fails.
+ * @return 0 if the node was inserted, 1 otherwise, in which case the list is unchanged.
  */
-void dlist_insert_next(Dlist * dlist, DlistNode * prev, void * data);
+int dlist_insert_next(Dlist * dlist, DlistNode * prev, void * data);
 
 /**
  * Inserts a new node before a given node.
@@ -51,9 +93,9 @@ void dlist_insert_next(Dlist * dlist, DlistNode * prev, void * data);
  * @param dlist Pointer to the doubly linked list.
  * @param next The node before which the new node will be inserted. Can be NULL to insert at the tail.
  * @param data Pointer to the data to store in the new node.
- * @return A pointer to the inserted data, or NULL if the operation fails.
+ * @return 0 if the node was inserted, 1 otherwise, in which case the list is unchanged.
  */
-void dlist_insert_prev(Dlist * dlist, DlistNode * next, void * data);
+int dlist_insert_prev(Dlist * dlist, DlistNode * next, void * data);
 
 /**
  * Removes the node immediately after a given node.
@@ -118,6 +160,68 @@ void dlist_rotate(Dlist * dlist, int i);
  */
 void dlist_new_first(Dlist * dlist, DlistNode * new_first);
 
+/**
+ * Moves a node of the list to the first position, right after the head.
+ * 
+ * Unlike dlist_new_first, which rotates the whole list, this relinks only the given
+ * node, keeping the order of the other ones. It takes constant time.
+ * 
+ * @param dlist Pointer to the doubly linked list.
+ * @param node The node to be moved. It must belong to dlist.
+ */
+void dlist_move_first(Dlist * dlist, DlistNode * node);
+
+/**
+ * Allocates several nodes in a single block owned by the list.
+ * 
+ * Only the block field of the nodes is set: data, next and prev are up to the caller,
+ * who links them into the list. Removing one of them from the list doesn't give its
+ * memory back; the whole block is freed once every node of it has been removed, or by
+ * dlist_terminate. Nodes never linked keep the block alive until then.
+ * 
+ * @param dlist Pointer to the doubly linked list that will own the nodes.
+ * @param n The number of nodes to allocate.
+ * @return A pointer to the first of n contiguous nodes, or NULL if n is not positive
+ *         or the allocation fails.
+ */
+DlistNode * dlist_alloc_nodes(Dlist * dlist, int n);
+
+/**
+ * Creates a list with one node per element of an array.
+ * 
+ * All the nodes are allocated in a single block and linked in one pass. The data of each
+ * node points to the corresponding element inside the array, so the array must outlive
+ * the list and must not be reallocated meanwhile.
+ * 
+ * @param array Pointer to the array.
+ * @param destroy Function to free the data of the nodes. Usually NULL, since the elements
+ *                belong to the array.
+ * @return A pointer to the new list, or NULL if array is NULL or the allocation fails.
+ */
+Dlist * dlist_from_array(Array * array, void (*destroy)(void * data));
+
+/**
+ * Attaches a membership filter to the list.
+ * 
+ * Once attached, dlist_search first asks the filter and returns NULL right away for most
+ * of the elements that are not in the list. Removals make the filter stale, and it is
+ * rebuilt by the next search. See list_attach_filter.
+ * 
+ * @param dlist Pointer to the doubly linked list.
+ * @param hash Hash function of the elements, consistent with the compare function.
+ * @param fp_rate Target false positive rate.
+ * @param max_bytes Memory budget of the filter, 0 for no limit.
+ * @return 0 on success, 1 otherwise.
+ */
+int dlist_attach_filter(Dlist * dlist, uint64_t (*hash)(void * data), double fp_rate, size_t max_bytes);
+
+/**
+ * Detaches and destroys the membership filter of the list, if any.
+ * 
+ * @param dlist Pointer to the doubly linked list.
+ */
+void dlist_detach_filter(Dlist * dlist);
+
 /**
  * Macro to access the head node of the list.
  * 
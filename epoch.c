@@ -0,0 +1,199 @@
+#define _DEFAULT_SOURCE
+#include "epoch.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <sched.h>
+
+#define EPOCH_ALLOCATION_ERROR "Memory allocation error for the epoch domain\n"
+
+#define EPOCH_NULL_POINTER "Epoch domain pointer parameter is NULL\n"
+
+#define EPOCH_NULL_RECLAIM "Reclaim function pointer parameter is NULL\n"
+
+#define EPOCH_UNKNOWN_RECORD "Record is not registered in the epoch domain\n"
+
+EpochDomain * epoch_init(void) {
+    EpochDomain * domain = malloc(sizeof(EpochDomain));
+    if (!domain) {
+        fputs(EPOCH_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    atomic_init(&domain->epoch, 0);
+    pthread_mutex_init(&domain->lock, NULL);
+    domain->records = NULL;
+    domain->retired[0] = domain->retired[1] = domain->retired[2] = NULL;
+    domain->num_retired = 0;
+
+    return domain;
+}
+
+/* Calls reclaim on a detached chain of entries and frees them */
+static void reclaim_all(EpochRetired * entry) {
+    while (entry) {
+        EpochRetired * next = entry->next;
+        entry->reclaim(entry->ptr, entry->ctx);
+        free(entry);
+        entry = next;
+    }
+}
+
+void epoch_terminate(EpochDomain * domain) {
+    if (!domain) {
+        fputs(EPOCH_NULL_POINTER, stderr);
+        return;
+    }
+
+    /* Oldest epoch first, so memory is released in retirement order */
+    uint_fast64_t epoch = atomic_load(&domain->epoch);
+    for (int i = 1; i <= 3; i++)
+        reclaim_all(domain->retired[(epoch + i) % 3]);
+
+    while (domain->records) {
+        EpochRecord * next = domain->records->next;
+        free(domain->records);
+        domain->records = next;
+    }
+
+    pthread_mutex_destroy(&domain->lock);
+    free(domain);
+}
+
+EpochRecord * epoch_register(EpochDomain * domain) {
+    if (!domain) {
+        fputs(EPOCH_NULL_POINTER, stderr);
+        return NULL;
+    }
+
+    EpochRecord * record = aligned_alloc(_Alignof(EpochRecord), sizeof(EpochRecord));
+    if (!record) {
+        fputs(EPOCH_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+    atomic_init(&record->state, 0);
+
+    pthread_mutex_lock(&domain->lock);
+    record->next = domain->records;
+    domain->records = record;
+    pthread_mutex_unlock(&domain->lock);
+
+    return record;
+}
+
+void epoch_unregister(EpochDomain * domain, EpochRecord * record) {
+    if (!domain) {
+        fputs(EPOCH_NULL_POINTER, stderr);
+        return;
+    }
+
+    int found = 0;
+
+    pthread_mutex_lock(&domain->lock);
+    for (EpochRecord ** link = &domain->records; *link; link = &(*link)->next) {
+        if (*link == record) {
+            *link = record->next;
+            found = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&domain->lock);
+
+    if (found)
+        free(record);
+    else
+        fputs(EPOCH_UNKNOWN_RECORD, stderr);
+}
+
+/* Moves the epoch forward if no active reader lags behind, detaching the
+ * entries that became safe to reclaim. Must be called with the lock held. */
+static int advance_locked(EpochDomain * domain, EpochRetired ** ready) {
+    uint_fast64_t epoch = atomic_load_explicit(&domain->epoch, memory_order_relaxed);
+
+    /* Pairs with the fence in epoch_enter: either the reader's state is seen
+     * here, or the reader sees every unlink done before this point */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    for (EpochRecord * record = domain->records; record; record = record->next) {
+        uint_fast64_t state = atomic_load_explicit(&record->state, memory_order_acquire);
+        if ((state & 1) && state >> 1 != epoch)
+            return 0;
+    }
+
+    atomic_store_explicit(&domain->epoch, epoch + 1, memory_order_seq_cst);
+
+    /* Every active reader has seen epoch, so none can hold what was retired
+     * in epoch - 1, which is now two epochs behind */
+    int bucket = (int) ((epoch + 2) % 3);
+    *ready = domain->retired[bucket];
+    domain->retired[bucket] = NULL;
+
+    for (EpochRetired * entry = *ready; entry; entry = entry->next)
+        domain->num_retired--;
+
+    return 1;
+}
+
+int epoch_retire(EpochDomain * domain, void * ptr, void (*reclaim)(void * ptr, void * ctx), void * ctx) {
+    if (!domain) {
+        fputs(EPOCH_NULL_POINTER, stderr);
+        return 1;
+    } else if (!reclaim) {
+        fputs(EPOCH_NULL_RECLAIM, stderr);
+        return 1;
+    }
+
+    EpochRetired * entry = malloc(sizeof(EpochRetired));
+    if (!entry) {
+        fputs(EPOCH_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    entry->ptr = ptr;
+    entry->reclaim = reclaim;
+    entry->ctx = ctx;
+
+    EpochRetired * ready = NULL;
+
+    pthread_mutex_lock(&domain->lock);
+    int bucket = (int) (atomic_load_explicit(&domain->epoch, memory_order_relaxed) % 3);
+    entry->next = domain->retired[bucket];
+    domain->retired[bucket] = entry;
+    domain->num_retired++;
+    advance_locked(domain, &ready);
+    pthread_mutex_unlock(&domain->lock);
+
+    /* Reclaim callbacks run outside the lock, so they may use the domain */
+    reclaim_all(ready);
+    return 0;
+}
+
+int epoch_advance(EpochDomain * domain) {
+    if (!domain) {
+        fputs(EPOCH_NULL_POINTER, stderr);
+        return 0;
+    }
+
+    EpochRetired * ready = NULL;
+
+    pthread_mutex_lock(&domain->lock);
+    int advanced = advance_locked(domain, &ready);
+    pthread_mutex_unlock(&domain->lock);
+
+    reclaim_all(ready);
+    return advanced;
+}
+
+void epoch_barrier(EpochDomain * domain) {
+    if (!domain) {
+        fputs(EPOCH_NULL_POINTER, stderr);
+        return;
+    }
+
+    /* Two advances flush what was retired up to the epoch it was called in */
+    for (int advances = 0; advances < 2; ) {
+        if (epoch_advance(domain))
+            advances++;
+        else
+            sched_yield();
+    }
+}
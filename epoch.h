@@ -0,0 +1,163 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+/**
+ * @file epoch.h
+ * @brief Epoch based reclamation for lock-free readers.
+ *
+ * Memory unlinked from a shared structure can't be freed right away, since
+ * readers running without locks may still be looking at it. Instead it is
+ * retired to the domain, which frees it once every reader that could have seen
+ * it has left its read-side critical section.
+ *
+ * The domain keeps a global epoch. A reader publishes the epoch it saw when it
+ * enters a critical section. The epoch moves forward only when every active
+ * reader has seen the current one, and memory retired during epoch e is freed
+ * once the global epoch reaches e + 2, when no reader can still hold it.
+ *
+ * Entering and leaving a critical section is a couple of plain stores and a
+ * fence: readers never take locks or perform read-modify-write operations.
+ * Critical sections must not be nested, and a reader stuck inside one holds
+ * back every reclamation of the domain.
+ */
+
+/**
+ * @brief Per thread reader state
+ *
+ * Each reading thread registers its own record with epoch_register. It sits
+ * alone in its cache line, since its owner writes it on every read section.
+ */
+typedef struct EpochRecord {
+    _Alignas(64) atomic_uint_fast64_t state;    /**< Epoch seen times 2, plus 1 while active. 0 when idle. */
+    struct EpochRecord * next;                  /**< Next record of the domain. */
+} EpochRecord;
+
+/**
+ * @brief Memory waiting to be reclaimed
+ */
+typedef struct EpochRetired {
+    void * ptr;                                 /**< Retired memory. */
+    void (*reclaim)(void * ptr, void * ctx);    /**< Function releasing it. */
+    void * ctx;                                 /**< User context given to reclaim. */
+    struct EpochRetired * next;                 /**< Next retired entry of the same epoch. */
+} EpochRetired;
+
+/**
+ * @brief The epoch domain structure
+ */
+typedef struct EpochDomain {
+    atomic_uint_fast64_t epoch;                 /**< The global epoch. */
+    pthread_mutex_t lock;                       /**< Guards records and retired lists. */
+    EpochRecord * records;                      /**< Registered readers. */
+    EpochRetired * retired[3];                  /**< Memory retired in each of the last three epochs. */
+    int num_retired;                            /**< Number of entries waiting to be reclaimed. */
+} EpochDomain;
+
+/**
+ * @brief Initializes a new epoch domain
+ *
+ * @return A pointer to the new domain, or NULL if memory allocation fails.
+ */
+EpochDomain * epoch_init(void);
+
+/**
+ * @brief Reclaims everything still retired and destroys the domain
+ *
+ * No reader may be inside a critical section, and every record is released.
+ *
+ * @param domain Pointer to the domain
+ */
+void epoch_terminate(EpochDomain * domain);
+
+/**
+ * @brief Registers a reader
+ *
+ * @param domain Pointer to the domain
+ *
+ * @return A record to be used by a single thread, or NULL on error.
+ */
+EpochRecord * epoch_register(EpochDomain * domain);
+
+/**
+ * @brief Unregisters a reader, which must be outside any critical section
+ *
+ * @param domain Pointer to the domain
+ *
+ * @param record Record returned by epoch_register
+ */
+void epoch_unregister(EpochDomain * domain, EpochRecord * record);
+
+/**
+ * @brief Enters a read-side critical section
+ *
+ * Shared memory reached between epoch_enter and epoch_exit stays valid until
+ * epoch_exit, even if it's retired meanwhile.
+ *
+ * @param domain Pointer to the domain
+ *
+ * @param record Record of the calling thread
+ */
+static inline void epoch_enter(EpochDomain * domain, EpochRecord * record) {
+    uint_fast64_t epoch = atomic_load_explicit(&domain->epoch, memory_order_relaxed);
+    atomic_store_explicit(&record->state, epoch * 2 + 1, memory_order_relaxed);
+    /* The state must be visible before any shared pointer is read */
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+/**
+ * @brief Leaves a read-side critical section
+ *
+ * @param record Record of the calling thread
+ */
+static inline void epoch_exit(EpochRecord * record) {
+    atomic_store_explicit(&record->state, 0, memory_order_release);
+}
+
+/**
+ * @brief Retires memory, to be reclaimed once no reader can reach it
+ *
+ * The memory must have been unlinked from every shared structure before. It
+ * also tries to move the epoch forward.
+ *
+ * @param domain Pointer to the domain
+ *
+ * @param ptr Memory retired
+ *
+ * @param reclaim Function called as reclaim(ptr, ctx) once it's safe
+ *
+ * @param ctx User context given to reclaim
+ *
+ * @return 0 on success, 1 otherwise. On failure nothing is retired.
+ */
+int epoch_retire(EpochDomain * domain, void * ptr, void (*reclaim)(void * ptr, void * ctx), void * ctx);
+
+/**
+ * @brief Moves the epoch forward if every active reader has seen it
+ *
+ * It reclaims whatever became safe to reclaim as a result.
+ *
+ * @param domain Pointer to the domain
+ *
+ * @return 1 if the epoch moved forward, 0 otherwise.
+ */
+int epoch_advance(EpochDomain * domain);
+
+/**
+ * @brief Waits until everything retired so far has been reclaimed
+ *
+ * It must not be called from inside a critical section.
+ *
+ * @param domain Pointer to the domain
+ */
+void epoch_barrier(EpochDomain * domain);
+
+/**
+ * @brief Number of retired entries not reclaimed yet
+ */
+#define epoch_num_retired(domain) ((domain)->num_retired)
+
+#endif
@@ -16,48 +16,157 @@
 
 #define NULL_COMPARE_POINTER "Param comapare is null"
 
+#define NULL_DATA_POINTER "Param data is null\n"
+
+#define NULL_ARRAY_POINTER "Array pointer is null\n"
+
+#define NULL_REGION_POINTER "Region pointer is null\n"
+
+#define ALLOCATOR_MISMATCH "Lists with different allocators can't be merged\n"
+
 List *list_init(void (*destroy)(void *data)) {
-    List *list = malloc(sizeof(List));
+    return list_init_with(destroy, NULL);
+}
+
+List *list_init_region(Region *region) {
+    if (!region) {
+        fputs(NULL_REGION_POINTER, stderr);
+        return NULL;
+    }
+
+    return list_init_with(NULL, region_allocator(region));
+}
+
+List *list_init_with(void (*destroy)(void *data), const Allocator *allocator) {
+    allocator = allocator_or_default(allocator);
+
+    List *list = allocator_alloc(allocator, sizeof(List));
 
     if (list == NULL) {
       fputs(LIST_ALLOCATION_ERROR, stderr);
-      exit(1); 
+      return NULL;
     }
 
-    ListNode *head = malloc(sizeof(ListNode));
+    ListNode *head = allocator_alloc(allocator, sizeof(ListNode));
 
     if (head == NULL) {
         fputs(LIST_NODE_ALLOCATION_ERROR, stderr); 
-        exit(1);
+        allocator_free(allocator, list);
+        return NULL;
     }
 
     head->next = NULL;
+    head->block = NULL;
 
     list->head = list->tail = head;
     list->num_elem = 0;
     list->destroy = destroy;
+    list->blocks = NULL;
+    list->heap_nodes = 0;
+    list->filter = NULL;
+    list->allocator = allocator;
 
     return list;
 }
 
-void list_insert_next(List *list, ListNode *previous, void *data) {
+ListNode *list_alloc_nodes(List *list, int n) {
     if (!list) {
         fputs(NULL_LIST_POINTER, stderr);
+        return NULL;
+    } else if (n <= 0) {
+        return NULL;
+    }
+
+    ListNodeBlock *block = allocator_alloc(list->allocator, sizeof(ListNodeBlock) + (size_t)n * sizeof(ListNode));
+
+    if (block == NULL) {
+        fputs(LIST_NODE_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    block->num_nodes = n;
+    block->num_live = n;
+    block->prev = NULL;
+    block->next = list->blocks;
+    if (list->blocks != NULL)
+        list->blocks->prev = block;
+    list->blocks = block;
+
+    for (int i = 0; i < n; i++)
+        block->nodes[i].block = block;
+
+    return block->nodes;
+}
+
+/* Frees a node allocated on its own, or the block of a node once the block
+ * has no node in use left */
+static void list_release_node(List *list, ListNode *node) {
+    ListNodeBlock *block = node->block;
+
+    if (block == NULL) {
+        allocator_free(list->allocator, node);
+        list->heap_nodes--;
         return;
+    }
+
+    if (--block->num_live > 0)
+        return;
+
+    if (block->prev != NULL)
+        block->prev->next = block->next;
+    else
+        list->blocks = block->next;
+    if (block->next != NULL)
+        block->next->prev = block->prev;
+
+    allocator_free(list->allocator, block);
+}
+
+/* Moves the node blocks of src to dst, so dst keeps them alive */
+static void list_adopt_blocks(List *dst, List *src) {
+    if (src->blocks == NULL)
+        return;
+
+    ListNodeBlock *last = src->blocks;
+
+    while (last->next != NULL)
+        last = last->next;
+
+    last->next = dst->blocks;
+    if (dst->blocks != NULL)
+        dst->blocks->prev = last;
+    dst->blocks = src->blocks;
+    src->blocks = NULL;
+}
+
+/* The elements of src now belong to dst, whose filter doesn't know them */
+static void list_merge_filters(List *dst, List *src) {
+    if (dst->filter)
+        bloom_invalidate(dst->filter);
+    if (src->filter)
+        bloom_terminate(src->filter);
+    src->filter = NULL;
+}
+
+int list_insert_next(List *list, ListNode *previous, void *data) {
+    if (!list) {
+        fputs(NULL_LIST_POINTER, stderr);
+        return 1;
     } else if (!previous) {
         fputs(PREVIOUS_PARAM_NULL, stderr);
-        return;
+        return 1;
     }
    
-    ListNode *new_elem = malloc(sizeof(ListNode));
+    ListNode *new_elem = allocator_alloc(list->allocator, sizeof(ListNode));
 
     if (new_elem == NULL) {
         fputs(LIST_NODE_ALLOCATION_ERROR, stderr); 
-        exit(1);
+        return 1;
     }
 
     new_elem->data = data;
     new_elem->next = previous->next;
+    new_elem->block = NULL;
 
     if (new_elem->next == NULL)
         list->tail = new_elem;
@@ -65,6 +174,12 @@ void list_insert_next(List *list, ListNode *previous, void *data) {
     previous->next = new_elem;
 
     list_num_elem(list)++;
+    list->heap_nodes++;
+
+    if (list->filter)
+        bloom_add(list->filter, data);
+
+    return 0;
 }
 
 void list_remove_next(List *list, ListNode *previous) {
@@ -91,7 +206,12 @@ void list_remove_next(List *list, ListNode *previous) {
     if (previous->next == NULL)
         list->tail = previous;
 
+    list_release_node(list, old);
+
     list->num_elem--;
+
+    if (list->filter)
+        bloom_invalidate(list->filter);
 }
 
 void list_terminate(List *list) {
@@ -100,16 +220,154 @@ void list_terminate(List *list) {
         return;
     }
 
-    while (list->head->next != NULL) {
-        list_remove_next(list, list->head);
+    if (list->filter)
+        bloom_terminate(list->filter);
+    list->filter = NULL;
+
+    /* Everything else goes away with the region */
+    if (!list->destroy && allocator_frees_in_bulk(list->allocator))
+        return;
+
+    /* Nodes living in blocks go away with their block, so the walk is only
+     * needed to destroy data or free nodes allocated one by one */
+    if (list->destroy || list->heap_nodes > 0) {
+        while (list->head->next != NULL) {
+            list_remove_next(list, list->head);
+        }
     }
 
-    free(list_head(list));
-    free(list);
+    while (list->blocks != NULL) {
+        ListNodeBlock *next = list->blocks->next;
+        allocator_free(list->allocator, list->blocks);
+        list->blocks = next;
+    }
+
+    allocator_free(list->allocator, list_head(list));
+    allocator_free(list->allocator, list);
 }
 
-void list_append(List *list, void *data) {
-    list_insert_next(list, list_tail(list), data);
+int list_append(List *list, void *data) {
+    if (!list) {
+        fputs(NULL_LIST_POINTER, stderr);
+        return 1;
+    }
+
+    return list_insert_next(list, list_tail(list), data);
+}
+
+int list_append_n(List *list, void **data, int n) {
+    if (!list) {
+        fputs(NULL_LIST_POINTER, stderr);
+        return 1;
+    } else if (n <= 0) {
+        return 0;
+    } else if (!data) {
+        fputs(NULL_DATA_POINTER, stderr);
+        return 1;
+    }
+
+    ListNode *nodes = list_alloc_nodes(list, n);
+
+    if (nodes == NULL)
+        return 1;
+
+    for (int i = 0; i < n; i++) {
+        nodes[i].data = data[i];
+        nodes[i].next = &nodes[i + 1];
+        if (list->filter)
+            bloom_add(list->filter, data[i]);
+    }
+    nodes[n - 1].next = NULL;
+
+    list_tail(list)->next = nodes;
+    list_tail(list) = &nodes[n - 1];
+    list_num_elem(list) += n;
+
+    return 0;
+}
+
+List *list_from_array(Array *array, void (*destroy)(void *data)) {
+    if (!array) {
+        fputs(NULL_ARRAY_POINTER, stderr);
+        return NULL;
+    }
+
+    List *list = list_init(destroy);
+    int n = array->num_elem;
+
+    if (list == NULL || n == 0)
+        return list;
+
+    ListNode *nodes = list_alloc_nodes(list, n);
+
+    if (nodes == NULL) {
+        list_terminate(list);
+        return NULL;
+    }
+
+    char *elem = array->list;
+
+    for (int i = 0; i < n; i++, elem += array->elem_size) {
+        nodes[i].data = elem;
+        nodes[i].next = &nodes[i + 1];
+    }
+    nodes[n - 1].next = NULL;
+
+    list_head(list)->next = nodes;
+    list_tail(list) = &nodes[n - 1];
+    list_num_elem(list) = n;
+
+    return list;
+}
+
+/* Refills the filter with every element of the list */
+static int list_filter_rebuild(const List *list) {
+    int capacity = 2 * list->num_elem;
+
+    if (bloom_reset(list->filter, capacity))
+        return 1;
+
+    for (ListNode *walker = list->head->next; walker != NULL; walker = walker->next)
+        bloom_add(list->filter, walker->data);
+
+    return 0;
+}
+
+/* Whether the filter can answer searches, rebuilding it first if it's stale */
+static int list_filter_ready(const List *list) {
+    return !bloom_stale(list->filter) || !list_filter_rebuild(list);
+}
+
+int list_attach_filter(List *list, uint64_t (*hash)(void *data), double fp_rate, size_t max_bytes) {
+    if (!list) {
+        fputs(NULL_LIST_POINTER, stderr);
+        return 1;
+    }
+
+    Bloom *filter = bloom_init(hash, 2 * list->num_elem, fp_rate, max_bytes);
+
+    if (filter == NULL)
+        return 1;
+
+    if (list->filter)
+        bloom_terminate(list->filter);
+    list->filter = filter;
+
+    for (ListNode *walker = list->head->next; walker != NULL; walker = walker->next)
+        bloom_add(filter, walker->data);
+
+    return 0;
+}
+
+void list_detach_filter(List *list) {
+    if (!list) {
+        fputs(NULL_LIST_POINTER, stderr);
+        return;
+    }
+
+    if (list->filter)
+        bloom_terminate(list->filter);
+    list->filter = NULL;
 }
 
 ListNode *list_search(const List *list, int (*compare)(void *a, void *b), void *x) {
@@ -121,6 +379,9 @@ ListNode *list_search(const List *list, int (*compare)(void *a, void *b), void *
         return NULL;
     }
 
+    if (list->filter && list_filter_ready(list) && !bloom_may_contain(list->filter, x))
+        return NULL;
+
     ListNode *tracer = list_head(list);
 
     while (tracer->next != NULL) {
@@ -136,21 +397,36 @@ List *list_merge(List *list1, List *list2, void (*destroy)(void *data)) {
     if (!list1 || !list2) {
         fputs(NULL_LIST_POINTER, stderr);
         return NULL;
+    } else if (list1->allocator != list2->allocator) {
+        fputs(ALLOCATOR_MISMATCH, stderr);
+        return NULL;
     }
 
     list1->tail->next = list2->head->next;
     
     list1->num_elem += list2->num_elem;
+    list1->heap_nodes += list2->heap_nodes;
 
     list1->destroy = destroy;
 
-    free(list2->head);
-    free(list2);
+    list_adopt_blocks(list1, list2);
+    list_merge_filters(list1, list2);
+
+    allocator_free(list2->allocator, list2->head);
+    allocator_free(list2->allocator, list2);
 
     return list1;
 }
 
 List *list_merge_sorted(List *list1, List *list2, void (*destroy)(void *data), int (*compare)(void *a, void *b)) {
+    if (!list1 || !list2) {
+        fputs(NULL_LIST_POINTER, stderr);
+        return NULL;
+    } else if (list1->allocator != list2->allocator) {
+        fputs(ALLOCATOR_MISMATCH, stderr);
+        return NULL;
+    }
+
     ListNode *walker1 = list1->head->next,
              *walker2 = list2->head->next,
              dummy,
@@ -176,12 +452,16 @@ List *list_merge_sorted(List *list1, List *list2, void (*destroy)(void *data), i
         tail->next = walker1;
     
     list1->num_elem += list2->num_elem;
+    list1->heap_nodes += list2->heap_nodes;
 
     list1->head->next = dummy.next;
 
     list1->destroy = destroy;
 
-    free(list2->head); free(list2);
+    list_adopt_blocks(list1, list2);
+    list_merge_filters(list1, list2);
+
+    allocator_free(list2->allocator, list2->head); allocator_free(list2->allocator, list2);
 
     return list1;
 }
@@ -1,6 +1,11 @@
 #ifndef LINKED_LIST_H
 #define LINKED_LIST_H
 
+#include "array.h"
+#include "bloom.h"
+#include "allocator.h"
+#include "region.h"
+
 /**
  * @file linked_list.h
  * @brief Header file for linked list initialization and management.
@@ -12,8 +17,24 @@
 typedef struct _ListNode {
     void *data;               /**< Pointer to the data stored in the node. */
     struct _ListNode *next;   /**< Pointer to the next node in the list. */
+    struct _ListNodeBlock *block; /**< Block the node lives in, NULL if allocated on its own. */
 } ListNode;
 
+/**
+ * @brief A block of nodes allocated at once.
+ *
+ * Nodes inside a block are not freed one by one when removed from the list.
+ * The block counts the nodes still in use and is freed when the last of them
+ * is removed, or when the list that owns it is terminated.
+ */
+typedef struct _ListNodeBlock {
+    struct _ListNodeBlock *next;  /**< Next block owned by the same list. */
+    struct _ListNodeBlock *prev;  /**< Previous block owned by the same list. */
+    int num_nodes;                /**< Number of nodes in the block. */
+    int num_live;                 /**< Nodes not removed from the list yet. */
+    ListNode nodes[];             /**< The nodes themselves. */
+} ListNodeBlock;
+
 /**
  * @brief Structure representing a linked list.
  */
@@ -22,6 +43,10 @@ typedef struct _List {
     ListNode *tail;           /**< Pointer to the tail node of the list. */
     int num_elem;             /**< Number of elements in the list. */
     void (*destroy)(void *data); /**< Function pointer to the element destructor. */
+    ListNodeBlock *blocks;    /**< Node blocks owned by the list, NULL if none. */
+    int heap_nodes;           /**< Number of nodes allocated one by one, outside any block. */
+    Bloom *filter;            /**< Optional membership filter checked by list_search, NULL if none. */
+    const Allocator *allocator; /**< Allocator of the list structure and its nodes. */
 } List;
 
 /**
@@ -42,6 +67,32 @@ typedef struct _List {
  */
 List *list_init(void (*destroy)(void *data));
 
+/**
+ * @brief Initializes a new list whose memory comes from an allocator.
+ *
+ * The list structure, its head and all its nodes are allocated with the given
+ * allocator, which must outlive the list. See list_init.
+ *
+ * @param destroy Element destructor, or NULL.
+ * @param allocator The allocator. NULL selects the C library one.
+ *
+ * @return A pointer to the newly created list structure, or NULL if memory allocation fails.
+ */
+List *list_init_with(void (*destroy)(void *data), const Allocator *allocator);
+
+/**
+ * @brief Initializes a new list bound to a region.
+ *
+ * The list and its nodes live in the region, and its elements are expected to
+ * be allocated from it too. list_terminate then only releases the filter,
+ * without walking the nodes, and region_terminate frees the rest.
+ *
+ * @param region The region, which must outlive the list.
+ *
+ * @return A pointer to the newly created list structure, or NULL if memory allocation fails.
+ */
+List *list_init_region(Region *region);
+
 /**
  * @brief Inserts a new element into the list after the specified node.
  *
@@ -53,8 +104,10 @@ List *list_init(void (*destroy)(void *data));
  * @param previous A pointer to the node after which the new element should be inserted.
  *                 If NULL, the element is inserted at the head of the list.
  * @param data A pointer to the data to be inserted into the list.
+ *
+ * @return 0 if the element was inserted, 1 otherwise, in which case the list is unchanged.
  */
-void list_insert_next(List *list, ListNode *previous, void *data);
+int list_insert_next(List *list, ListNode *previous, void *data);
 
 /**
  * @brief Removes the element from the list immediately after the specified node.
@@ -86,8 +139,10 @@ void list_terminate(List *list);
  * 
  * @param list A pointer to the list structure where the new node will be inserted
  * @param data A pointer to data to be inserted into list.
+ *
+ * @return 0 if the element was appended, 1 otherwise.
  */
-void list_append(List *list, void *data);
+int list_append(List *list, void *data);
 
 
 /**
@@ -129,7 +184,8 @@ ListNode *list_search(const List *list, int (*compare)(void *a, void *b), void *
  * @param list2 A pointer to the second list structure.
  * @param destroy A pointer to a function to destroy the elements. If no cleanup is required, pass NULL.
  *
- * @return A pointer to the newly merged list structure, or NULL if memory allocation fails.
+ * @return A pointer to the newly merged list structure, or NULL if the lists don't share
+ *         the same allocator, in which case both are left untouched.
  * 
  * @note list1 and list2 pointers shall be no longer used once the memory space allocated for them
  *       will be liberated in to order to prevent data conflict among their usage and the new merged list
@@ -151,7 +207,8 @@ List *list_merge(List *list1, List *list2, void (*destroy)(void *data));
  * @param destroy A pointer to a function to destroy the elements. If no cleanup is required, pass NULL.
  * @param compare A pointer to a function that compares two elements to determine their order.
  *
- * @return A pointer to the newly merged sorted list structure, or NULL if memory allocation fails.
+ * @return A pointer to the newly merged sorted list structure, or NULL if the lists don't
+ *         share the same allocator, in which case both are left untouched.
  */
 List *list_merge_sorted(List *list1, List *list2, void (*destroy)(void *data), int (*compare)(void *a, void *b));
 
@@ -166,6 +223,78 @@ List *list_merge_sorted(List *list1, List *list2, void (*destroy)(void *data), i
  */
 void list_reverse(List *list);
 
+/**
+ * @brief Allocates several nodes in a single block owned by the list.
+ *
+ * Only the block field of the nodes is set: data and next are up to the caller,
+ * who links them into the list. Removing one of them from the list doesn't
+ * give its memory back; the whole block is freed once every node of it has
+ * been removed, or by list_terminate. Nodes never linked keep the block alive
+ * until then.
+ *
+ * @param list A pointer to the list structure that will own the nodes.
+ * @param n The number of nodes to allocate.
+ *
+ * @return A pointer to the first of n contiguous nodes, or NULL if n is not
+ *         positive or memory allocation fails.
+ */
+ListNode *list_alloc_nodes(List *list, int n);
+
+/**
+ * @brief Creates a list with one node per element of an array.
+ *
+ * All the nodes are allocated in a single block and linked in one pass. The data
+ * of each node points to the corresponding element inside the array, so the array
+ * must outlive the list and must not be reallocated meanwhile.
+ *
+ * @param array A pointer to the array.
+ * @param destroy A pointer to a function to destroy the elements. Usually NULL,
+ *                since the elements belong to the array.
+ *
+ * @return A pointer to the new list, or NULL if array is NULL or memory allocation fails.
+ */
+List *list_from_array(Array *array, void (*destroy)(void *data));
+
+/**
+ * @brief Appends several elements at list end.
+ *
+ * It does the same as calling list_append for each element, but all the nodes
+ * are allocated in a single block and linked in one pass.
+ *
+ * @param list A pointer to the list structure.
+ * @param data An array of n pointers to the data to be appended, in order.
+ * @param n The number of elements to append.
+ *
+ * @return 0 if the elements were appended, 1 otherwise. The list is unchanged on failure.
+ */
+int list_append_n(List *list, void **data, int n);
+
+/**
+ * @brief Attaches a membership filter to the list.
+ *
+ * Once attached, list_search first asks the filter and returns NULL right away
+ * for most of the elements that are not in the list, without walking it. The
+ * filter learns every inserted element; removals make it stale and it is rebuilt
+ * by the next search, as it is when the list outgrows it.
+ *
+ * @param list A pointer to the list structure.
+ * @param hash Hash function of the elements. Elements equal for the compare function
+ *             given to list_search must have the same hash.
+ * @param fp_rate Target false positive rate, that is, the share of misses still walking
+ *                the list. See bloom_init.
+ * @param max_bytes Memory budget of the filter, 0 for no limit.
+ *
+ * @return 0 on success, 1 otherwise. A filter already attached is replaced.
+ */
+int list_attach_filter(List *list, uint64_t (*hash)(void *data), double fp_rate, size_t max_bytes);
+
+/**
+ * @brief Detaches and destroys the membership filter of the list, if any.
+ *
+ * @param list A pointer to the list structure.
+ */
+void list_detach_filter(List *list);
+
 /**
  * @brief Prints all the elements of List
  * 
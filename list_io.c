@@ -0,0 +1,424 @@
+#define _DEFAULT_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include "list_io.h"
+
+#define NULL_LIST_POINTER "List pointer is null\n"
+
+#define NULL_CODER_POINTER "Encoder or decoder pointer is null\n"
+
+#define STREAM_ALLOCATION_ERROR "Error in memory allocation for stream buffer\n"
+
+#define STREAM_WRITE_ERROR "Error writing list stream\n"
+
+#define STREAM_READ_ERROR "Error reading list stream\n"
+
+#define STREAM_FORMAT_ERROR "Invalid list stream\n"
+
+#define STREAM_DECODE_ERROR "Element decoder failed\n"
+
+#define STREAM_MAGIC "DSALST01"
+
+/* Size of the buffers gathering reads and writes */
+#define STREAM_BUFFER_SIZE (1 << 20)
+
+/* Nodes of the first block allocated by a load, doubling for each next one.
+ * Blocks grow as frames arrive, so a header announcing more elements than the
+ * stream holds can't force a huge allocation up front. */
+#define FIRST_NODE_BATCH 256
+
+#define MAX_NODE_BATCH (1 << 16)
+
+/* Bytes of the length prefix of each frame */
+#define FRAME_HEADER_SIZE sizeof(uint32_t)
+
+typedef struct StreamHeader {
+    char magic[8];
+    uint64_t num_elem;
+} StreamHeader;
+
+/* ---------------------------------------------------------------------------
+ * Buffered writing
+ * ------------------------------------------------------------------------- */
+
+typedef struct StreamWriter {
+    int fd;
+    char *buf;
+    size_t len;
+    size_t cap;
+} StreamWriter;
+
+static int write_all(int fd, const void *data, size_t n) {
+    const char *p = data;
+
+    while (n > 0) {
+        ssize_t done = write(fd, p, n);
+        if (done < 0) {
+            if (errno == EINTR)
+                continue;
+            return 1;
+        }
+        p += done;
+        n -= done;
+    }
+    return 0;
+}
+
+static int writer_flush(StreamWriter *w) {
+    if (write_all(w->fd, w->buf, w->len))
+        return 1;
+    w->len = 0;
+    return 0;
+}
+
+static int writer_put(StreamWriter *w, const void *data, size_t n) {
+    if (w->cap - w->len < n && writer_flush(w))
+        return 1;
+    memcpy(w->buf + w->len, data, n);
+    w->len += n;
+    return 0;
+}
+
+/* Encodes one element straight into the buffer. Elements too large for an
+ * empty buffer are encoded apart and written on their own. */
+static int writer_frame(StreamWriter *w, size_t (*encode)(void *data, void *buf, size_t cap), void *data) {
+    for (;;) {
+        if (w->cap - w->len < FRAME_HEADER_SIZE && writer_flush(w))
+            return 1;
+
+        size_t room = w->cap - w->len - FRAME_HEADER_SIZE;
+        size_t need = encode(data, w->buf + w->len + FRAME_HEADER_SIZE, room);
+
+        if (need > UINT32_MAX)
+            return 1;
+
+        if (need <= room) {
+            uint32_t frame_len = (uint32_t)need;
+            memcpy(w->buf + w->len, &frame_len, FRAME_HEADER_SIZE);
+            w->len += FRAME_HEADER_SIZE + need;
+            return 0;
+        }
+
+        if (w->len > 0) {
+            if (writer_flush(w))
+                return 1;
+            continue;
+        }
+
+        char *big = malloc(need);
+        if (!big) {
+            fputs(STREAM_ALLOCATION_ERROR, stderr);
+            return 1;
+        }
+
+        uint32_t frame_len = (uint32_t)need;
+        int failed = encode(data, big, need) != need
+                  || write_all(w->fd, &frame_len, FRAME_HEADER_SIZE)
+                  || write_all(w->fd, big, need);
+        free(big);
+        return failed;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Buffered reading
+ * ------------------------------------------------------------------------- */
+
+typedef struct StreamReader {
+    int fd;
+    char *buf;
+    size_t pos;
+    size_t len;
+    size_t cap;
+    int seekable;   /* read ahead freely, seeking back over the unused bytes at the end */
+} StreamReader;
+
+/* Makes sure at least want unread bytes are in the buffer, growing it when a
+ * frame is larger than the buffer. It grows by doubling as the bytes actually
+ * arrive, so a forged frame length fails at end of file rather than forcing a
+ * huge allocation. Descriptors that can't seek back are read no further than
+ * needed, so whatever follows the list stays in the stream.
+ * Returns 1 on error or early end of file. */
+static int reader_fill(StreamReader *r, size_t want) {
+    if (r->len - r->pos >= want)
+        return 0;
+
+    memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+    r->len -= r->pos;
+    r->pos = 0;
+
+    while (r->len < want) {
+        if (r->len == r->cap) {
+            size_t new_cap = r->cap < want / 2 ? 2 * r->cap : want;
+            char *bigger = realloc(r->buf, new_cap);
+            if (!bigger) {
+                fputs(STREAM_ALLOCATION_ERROR, stderr);
+                return 1;
+            }
+            r->buf = bigger;
+            r->cap = new_cap;
+        }
+
+        size_t room = r->seekable ? r->cap - r->len
+                    : (want < r->cap ? want : r->cap) - r->len;
+        ssize_t got = read(r->fd, r->buf + r->len, room);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0) {
+            fputs(STREAM_READ_ERROR, stderr);
+            return 1;
+        }
+        r->len += got;
+    }
+    return 0;
+}
+
+/* Leaves a seekable descriptor right after the last byte consumed */
+static void reader_finish(StreamReader *r) {
+    if (r->seekable && r->len > r->pos)
+        lseek(r->fd, -(off_t)(r->len - r->pos), SEEK_CUR);
+}
+
+/* Nodes of the next block of a load, given the previous block and the number
+ * of elements left */
+static int node_batch(int previous, uint64_t left) {
+    uint64_t batch = previous == 0 ? FIRST_NODE_BATCH
+                   : previous >= MAX_NODE_BATCH / 2 ? MAX_NODE_BATCH : 2 * previous;
+    return (int)(batch < left ? batch : left);
+}
+
+/* Reads the next frame and decodes it. Returns 1 on failure. */
+static int reader_frame(StreamReader *r, void *(*decode)(const void *buf, size_t len), void **data) {
+    uint32_t frame_len;
+
+    if (reader_fill(r, FRAME_HEADER_SIZE))
+        return 1;
+    memcpy(&frame_len, r->buf + r->pos, FRAME_HEADER_SIZE);
+    r->pos += FRAME_HEADER_SIZE;
+
+    if (reader_fill(r, frame_len))
+        return 1;
+
+    *data = decode(r->buf + r->pos, frame_len);
+    r->pos += frame_len;
+
+    if (*data == NULL) {
+        fputs(STREAM_DECODE_ERROR, stderr);
+        return 1;
+    }
+    return 0;
+}
+
+static int reader_header(StreamReader *r, uint64_t *num_elem) {
+    StreamHeader header;
+
+    if (reader_fill(r, sizeof(header)))
+        return 1;
+    memcpy(&header, r->buf + r->pos, sizeof(header));
+    r->pos += sizeof(header);
+
+    if (memcmp(header.magic, STREAM_MAGIC, sizeof(header.magic)) != 0 || header.num_elem > INT32_MAX) {
+        fputs(STREAM_FORMAT_ERROR, stderr);
+        return 1;
+    }
+
+    *num_elem = header.num_elem;
+    return 0;
+}
+
+static int writer_header(StreamWriter *w, int num_elem) {
+    StreamHeader header;
+
+    memcpy(header.magic, STREAM_MAGIC, sizeof(header.magic));
+    header.num_elem = (uint64_t)num_elem;
+
+    return writer_put(w, &header, sizeof(header));
+}
+
+/* ---------------------------------------------------------------------------
+ * List and Dlist front ends
+ * ------------------------------------------------------------------------- */
+
+int list_save(List *list, int fd, size_t (*encode)(void *data, void *buf, size_t cap)) {
+    if (!list) {
+        fputs(NULL_LIST_POINTER, stderr);
+        return 1;
+    } else if (!encode) {
+        fputs(NULL_CODER_POINTER, stderr);
+        return 1;
+    }
+
+    StreamWriter w = { fd, malloc(STREAM_BUFFER_SIZE), 0, STREAM_BUFFER_SIZE };
+    if (!w.buf) {
+        fputs(STREAM_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    int failed = writer_header(&w, list_num_elem(list));
+
+    for (ListNode *walker = list_head(list)->next; walker != NULL && !failed; walker = walker->next)
+        failed = writer_frame(&w, encode, walker->data);
+
+    if (!failed)
+        failed = writer_flush(&w);
+
+    if (failed)
+        fputs(STREAM_WRITE_ERROR, stderr);
+
+    free(w.buf);
+    return failed;
+}
+
+List *list_load(int fd, void *(*decode)(const void *buf, size_t len), void (*destroy)(void *data)) {
+    if (!decode) {
+        fputs(NULL_CODER_POINTER, stderr);
+        return NULL;
+    }
+
+    StreamReader r = { fd, malloc(STREAM_BUFFER_SIZE), 0, 0, STREAM_BUFFER_SIZE, lseek(fd, 0, SEEK_CUR) >= 0 };
+    if (!r.buf) {
+        fputs(STREAM_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    uint64_t num_elem;
+    if (reader_header(&r, &num_elem)) {
+        free(r.buf);
+        return NULL;
+    }
+
+    List *list = list_init(destroy);
+    if (!list) {
+        free(r.buf);
+        return NULL;
+    }
+
+    ListNode *nodes = NULL;
+    int batch = 0, used = 0;
+
+    /* Each node is linked right after it's decoded, so a failure midway leaves
+     * a consistent list that list_terminate can clean up */
+    for (uint64_t i = 0; i < num_elem; i++) {
+        if (used == batch) {
+            batch = node_batch(batch, num_elem - i);
+            used = 0;
+            nodes = list_alloc_nodes(list, batch);
+            if (!nodes) {
+                list_terminate(list);
+                free(r.buf);
+                return NULL;
+            }
+        }
+
+        ListNode *node = &nodes[used++];
+
+        if (reader_frame(&r, decode, &node->data)) {
+            list_terminate(list);
+            free(r.buf);
+            return NULL;
+        }
+
+        node->next = NULL;
+        list_tail(list)->next = node;
+        list_tail(list) = node;
+        list_num_elem(list)++;
+    }
+
+    reader_finish(&r);
+    free(r.buf);
+    return list;
+}
+
+int dlist_save(Dlist *dlist, int fd, size_t (*encode)(void *data, void *buf, size_t cap)) {
+    if (!dlist) {
+        fputs(NULL_LIST_POINTER, stderr);
+        return 1;
+    } else if (!encode) {
+        fputs(NULL_CODER_POINTER, stderr);
+        return 1;
+    }
+
+    StreamWriter w = { fd, malloc(STREAM_BUFFER_SIZE), 0, STREAM_BUFFER_SIZE };
+    if (!w.buf) {
+        fputs(STREAM_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    int failed = writer_header(&w, dlist_num_elem(dlist));
+
+    for (DlistNode *walker = dlist_head(dlist)->next; walker != dlist_head(dlist) && !failed; walker = walker->next)
+        failed = writer_frame(&w, encode, walker->data);
+
+    if (!failed)
+        failed = writer_flush(&w);
+
+    if (failed)
+        fputs(STREAM_WRITE_ERROR, stderr);
+
+    free(w.buf);
+    return failed;
+}
+
+Dlist *dlist_load(int fd, void *(*decode)(const void *buf, size_t len), void (*destroy)(void *data)) {
+    if (!decode) {
+        fputs(NULL_CODER_POINTER, stderr);
+        return NULL;
+    }
+
+    StreamReader r = { fd, malloc(STREAM_BUFFER_SIZE), 0, 0, STREAM_BUFFER_SIZE, lseek(fd, 0, SEEK_CUR) >= 0 };
+    if (!r.buf) {
+        fputs(STREAM_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    uint64_t num_elem;
+    if (reader_header(&r, &num_elem)) {
+        free(r.buf);
+        return NULL;
+    }
+
+    Dlist *dlist = dlist_init(destroy);
+    if (!dlist) {
+        free(r.buf);
+        return NULL;
+    }
+
+    DlistNode *head = dlist_head(dlist);
+    DlistNode *nodes = NULL;
+    int batch = 0, used = 0;
+
+    for (uint64_t i = 0; i < num_elem; i++) {
+        if (used == batch) {
+            batch = node_batch(batch, num_elem - i);
+            used = 0;
+            nodes = dlist_alloc_nodes(dlist, batch);
+            if (!nodes) {
+                dlist_terminate(dlist);
+                free(r.buf);
+                return NULL;
+            }
+        }
+
+        DlistNode *node = &nodes[used++];
+
+        if (reader_frame(&r, decode, &node->data)) {
+            dlist_terminate(dlist);
+            free(r.buf);
+            return NULL;
+        }
+
+        node->prev = head->prev;
+        node->next = head;
+        head->prev->next = node;
+        head->prev = node;
+        dlist_num_elem(dlist)++;
+    }
+
+    reader_finish(&r);
+    free(r.buf);
+    return dlist;
+}
@@ -0,0 +1,77 @@
+#ifndef LIST_IO_H
+#define LIST_IO_H
+
+#include <stddef.h>
+#include "linked_list.h"
+#include "dlist.h"
+
+/**
+ * @file list_io.h
+ * @brief Streaming binary serialization of List and Dlist.
+ *
+ * A serialized list is a short header holding the number of elements followed
+ * by one frame per element. Each frame is a 32 bits length and the bytes the
+ * user encoder produced for that element. Integers are written in the host
+ * byte order, so streams are meant to be read back on the same architecture.
+ *
+ * Writes are gathered in a large buffer and handed to the file descriptor in
+ * big chunks. Loading reads the stream the same way when the descriptor can
+ * seek, and then seeks back over what it read past the list, so the descriptor
+ * is left right after it. Other descriptors, such as pipes and sockets, are
+ * read no further than the list. Nodes are allocated in blocks (see
+ * list_alloc_nodes) doubling in size as elements are decoded, so the element
+ * count of the header is not trusted with a large allocation.
+ *
+ * The element encoder has the prototype
+ *
+ *      size_t encode(void *data, void *buf, size_t cap);
+ *
+ * It must write the encoded data to buf and return the number of bytes used.
+ * If more than cap bytes are needed, it must write nothing and return the
+ * number of bytes it needs; it will be called again with a larger buffer.
+ *
+ * The element decoder has the prototype
+ *
+ *      void *decode(const void *buf, size_t len);
+ *
+ * It must build an element from the len bytes at buf and return a pointer to
+ * it, or NULL on failure, which aborts the load.
+ */
+
+/**
+ * @brief Writes all the elements of a list to a file descriptor.
+ *
+ * @param list A pointer to the list structure.
+ * @param fd An open file descriptor to write to.
+ * @param encode The element encoder.
+ *
+ * @return 0 if the whole list was written, 1 otherwise.
+ */
+int list_save(List *list, int fd, size_t (*encode)(void *data, void *buf, size_t cap));
+
+/**
+ * @brief Reads a list written by list_save from a file descriptor.
+ *
+ * @param fd An open file descriptor to read from.
+ * @param decode The element decoder.
+ * @param destroy The destroy function of the new list. It is also used to clean up
+ *                the elements already decoded if the load fails.
+ *
+ * @return A pointer to the new list, or NULL if the stream is invalid, a read fails
+ *         or the decoder fails.
+ */
+List *list_load(int fd, void *(*decode)(const void *buf, size_t len), void (*destroy)(void *data));
+
+/**
+ * @brief Same as list_save, but for doubly linked lists.
+ *
+ * Elements are written from the first one to the last one.
+ */
+int dlist_save(Dlist *dlist, int fd, size_t (*encode)(void *data, void *buf, size_t cap));
+
+/**
+ * @brief Same as list_load, but for doubly linked lists.
+ */
+Dlist *dlist_load(int fd, void *(*decode)(const void *buf, size_t len), void (*destroy)(void *data));
+
+#endif /* LIST_IO_H */
@@ -0,0 +1,399 @@
+#define _DEFAULT_SOURCE
+#include "loader.h"
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define SCHEDULER_NULL_POINTER "Scheduler pointer parameter is NULL\n"
+
+#define CONTAINER_NULL_POINTER "Target container pointer parameter is NULL\n"
+
+#define NULL_PARSER_POINTER "Parser pointer is null\n"
+
+#define LOADER_ALLOCATION_ERROR "Memory allocation error for the loader buffers\n"
+
+#define LOADER_READ_ERROR "Error reading records file\n"
+
+#define LOADER_FORMAT_ERROR "Records file ends in the middle of a record\n"
+
+#define LOADER_PARSE_ERROR "Record parser failed\n"
+
+/* Bytes read per chunk, not counting the partial record carried over */
+#define LOADER_CHUNK_SIZE (4 << 20)
+
+/* Chunks in flight per worker, so workers find the next chunk ready */
+#define LOADER_CHUNKS_PER_WORKER 2
+
+/* ---------------------------------------------------------------------------
+ * Chunk parsing, run by the scheduler tasks
+ * ------------------------------------------------------------------------- */
+
+typedef struct LoaderJob {
+    size_t record_size;             /* 0 for lines */
+    size_t elem_size;               /* bytes of a parsed element */
+    int (*parse_elem)(const char * record, size_t len, void * out, void * ctx);
+    void * (*parse_ptr)(const char * record, size_t len, void * ctx);
+    void * ctx;
+    atomic_int aborted;             /* set by the first failing chunk */
+} LoaderJob;
+
+typedef struct LoaderChunk {
+    TaskGroup group;                /* the task parsing the chunk */
+    LoaderJob * job;
+    char * buf;                     /* whole records only */
+    size_t len;
+    size_t cap;
+    Array * out;                    /* parsed elements, kept from one use to the next */
+    int failed;
+} LoaderChunk;
+
+/* Parses one record at the end of the chunk output */
+static int parse_record(LoaderChunk * chunk, const char * record, size_t len) {
+    LoaderJob * job = chunk->job;
+    Array * out = chunk->out;
+
+    if (out->num_elem == out->total_size &&
+        array_reallocate(out, out->total_size > 0 ? 2 * out->total_size : 1024))
+        return 1;
+
+    void * slot = (char *) out->list + (size_t) out->num_elem * out->elem_size;
+
+    if (job->parse_ptr) {
+        void * data = job->parse_ptr(record, len, job->ctx);
+        if (!data)
+            return 1;
+        memcpy(slot, &data, sizeof(void *));
+    } else if (job->parse_elem(record, len, slot, job->ctx)) {
+        return 1;
+    }
+
+    out->num_elem++;
+    return 0;
+}
+
+static void parse_chunk(void * arg) {
+    LoaderChunk * chunk = arg;
+    LoaderJob * job = chunk->job;
+    const char * p = chunk->buf;
+    const char * end = chunk->buf + chunk->len;
+
+    while (p < end && !chunk->failed) {
+        /* Chunks after a failed one are given up, their result is dropped */
+        if (atomic_load_explicit(&job->aborted, memory_order_relaxed)) {
+            chunk->failed = 1;
+            break;
+        }
+
+        const char * next;
+        size_t len;
+
+        if (job->record_size == LOADER_LINES) {
+            const char * nl = memchr(p, '\n', end - p);
+            len = (nl ? nl : end) - p;
+            next = nl ? nl + 1 : end;
+        } else {
+            len = job->record_size;
+            next = p + len;
+        }
+
+        if (parse_record(chunk, p, len)) {
+            fputs(LOADER_PARSE_ERROR, stderr);
+            atomic_store_explicit(&job->aborted, 1, memory_order_relaxed);
+            chunk->failed = 1;
+        }
+        p = next;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Reading
+ * ------------------------------------------------------------------------- */
+
+typedef struct LoaderReader {
+    int fd;
+    int seekable;                   /* read with pread from offset, or with read */
+    off_t offset;
+    int eof;
+    char * carry;                   /* partial record left by the previous chunk */
+    size_t carry_len;
+    size_t carry_cap;
+} LoaderReader;
+
+/* Reads up to n bytes, fewer only at end of file. Returns -1 on error. */
+static ssize_t reader_read(LoaderReader * r, char * buf, size_t n) {
+    size_t done = 0;
+
+    while (done < n) {
+        ssize_t got = r->seekable ? pread(r->fd, buf + done, n - done, r->offset)
+                                  : read(r->fd, buf + done, n - done);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0)
+            return -1;
+        if (got == 0) {
+            r->eof = 1;
+            break;
+        }
+        done += got;
+        r->offset += got;
+    }
+    return (ssize_t) done;
+}
+
+static int reserve(char ** buf, size_t * cap, size_t want) {
+    if (want <= *cap)
+        return 0;
+
+    size_t new_cap = *cap > 0 ? *cap : want;
+    while (new_cap < want)
+        new_cap *= 2;
+
+    char * bigger = realloc(*buf, new_cap);
+    if (!bigger) {
+        fputs(LOADER_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+    *buf = bigger;
+    *cap = new_cap;
+    return 0;
+}
+
+/* Length of the leading whole records of buf. At end of file a last line
+ * needs no '\n', while a partial fixed length record is an error. */
+static size_t whole_records(const LoaderJob * job, const char * buf, size_t len, int eof) {
+    if (job->record_size != LOADER_LINES)
+        return len - len % job->record_size;
+    if (eof)
+        return len;
+
+    size_t cut = len;
+    while (cut > 0 && buf[cut - 1] != '\n')
+        cut--;
+    return cut;
+}
+
+/* Fills a chunk with the carried partial record followed by the next bytes of
+ * the file, reading on until it holds a whole record or the file ends. What
+ * follows the last whole record is carried to the next chunk. */
+static int fill_chunk(LoaderReader * r, LoaderChunk * chunk) {
+    const LoaderJob * job = chunk->job;
+    size_t len = r->carry_len;
+
+    if (reserve(&chunk->buf, &chunk->cap, len + LOADER_CHUNK_SIZE))
+        return 1;
+    if (len > 0)
+        memcpy(chunk->buf, r->carry, len);
+
+    size_t cut = 0;
+    size_t want = LOADER_CHUNK_SIZE;
+
+    while (cut == 0 && !r->eof) {
+        if (reserve(&chunk->buf, &chunk->cap, len + want))
+            return 1;
+
+        ssize_t got = reader_read(r, chunk->buf + len, want);
+        if (got < 0) {
+            fputs(LOADER_READ_ERROR, stderr);
+            return 1;
+        }
+        len += got;
+        cut = whole_records(job, chunk->buf, len, r->eof);
+        want = len;             /* a record longer than a chunk: double up */
+    }
+
+    if (r->eof && cut < len) {
+        fputs(LOADER_FORMAT_ERROR, stderr);
+        return 1;
+    }
+
+    r->carry_len = len - cut;
+    if (r->carry_len > 0) {
+        if (reserve(&r->carry, &r->carry_cap, r->carry_len))
+            return 1;
+        memcpy(r->carry, chunk->buf + cut, r->carry_len);
+    }
+
+    chunk->len = cut;
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * Pipeline
+ * ------------------------------------------------------------------------- */
+
+/* Drops the elements parsed by a chunk, destroying them when asked */
+static void discard_chunk(LoaderChunk * chunk, void (*destroy)(void * data)) {
+    Array * out = chunk->out;
+    char * elem = out->list;
+
+    if (destroy) {
+        for (int i = 0; i < out->num_elem; i++, elem += out->elem_size) {
+            if (chunk->job->parse_ptr)
+                destroy(*(void **) elem);
+            else
+                destroy(elem);
+        }
+    }
+    out->num_elem = 0;
+}
+
+/*
+ * Reads the file into a ring of chunks. Each filled chunk is parsed by a task
+ * of its own while the next ones are read; once the ring is full, or the file
+ * is over, the oldest chunk is waited on and handed to append, which moves its
+ * elements to the container. Returns 1 if anything failed, in which case the
+ * elements of the chunks not appended yet are destroyed.
+ */
+static int loader_run(Scheduler * sched, int fd, LoaderJob * job, void (*destroy)(void * data),
+                      int (*append)(void * target, Array * elems), void * target) {
+    int num_chunks = scheduler_num_workers(sched) * LOADER_CHUNKS_PER_WORKER + 1;
+    LoaderChunk * chunks = calloc(num_chunks, sizeof(LoaderChunk));
+    if (!chunks) {
+        fputs(LOADER_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    int failed = 0;
+    for (int i = 0; i < num_chunks && !failed; i++) {
+        chunks[i].job = job;
+        chunks[i].out = array_init(NULL, 0, job->elem_size);
+        failed = !chunks[i].out;
+    }
+
+    LoaderReader r = { fd, 0, 0, 0, NULL, 0, 0 };
+    off_t start = lseek(fd, 0, SEEK_CUR);
+    if (start >= 0) {
+        r.seekable = 1;
+        r.offset = start;
+        posix_fadvise(fd, start, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    int next = 0, oldest = 0, in_flight = 0;
+
+    while (!failed && (!r.eof || in_flight > 0)) {
+        if (!r.eof && in_flight < num_chunks) {
+            LoaderChunk * chunk = &chunks[next];
+
+            if (fill_chunk(&r, chunk)) {
+                failed = 1;
+                break;
+            }
+            if (chunk->len == 0)
+                continue;
+
+            chunk->failed = 0;
+            task_group_init(&chunk->group);
+            if (scheduler_spawn(sched, &chunk->group, parse_chunk, chunk))
+                parse_chunk(chunk);     /* run inline when spawning fails */
+
+            next = (next + 1) % num_chunks;
+            in_flight++;
+            continue;
+        }
+
+        LoaderChunk * chunk = &chunks[oldest];
+        scheduler_wait(sched, &chunk->group);
+
+        if (chunk->failed || append(target, chunk->out)) {
+            failed = 1;
+            break;
+        }
+        chunk->out->num_elem = 0;
+
+        oldest = (oldest + 1) % num_chunks;
+        in_flight--;
+    }
+
+    /* After a failure, the chunks still in flight are stopped early and their
+     * elements dropped */
+    if (failed)
+        atomic_store(&job->aborted, 1);
+
+    for (; in_flight > 0; in_flight--, oldest = (oldest + 1) % num_chunks) {
+        scheduler_wait(sched, &chunks[oldest].group);
+        discard_chunk(&chunks[oldest], destroy);
+    }
+
+    if (!failed && r.seekable)
+        lseek(fd, r.offset, SEEK_SET);
+
+    for (int i = 0; i < num_chunks; i++) {
+        free(chunks[i].buf);
+        if (chunks[i].out)
+            array_terminate(chunks[i].out);
+    }
+    free(chunks);
+    free(r.carry);
+    return failed;
+}
+
+/* ---------------------------------------------------------------------------
+ * Array and List front ends
+ * ------------------------------------------------------------------------- */
+
+static int append_to_array(void * target, Array * elems) {
+    return array_append_n(target, elems->list, elems->num_elem);
+}
+
+static int append_to_list(void * target, Array * elems) {
+    return list_append_n(target, elems->list, elems->num_elem);
+}
+
+int loader_append_array(Scheduler * sched, int fd, size_t record_size, Array * array,
+                        int (*parse)(const char * record, size_t len, void * out, void * ctx), void * ctx) {
+    if (!sched) {
+        fputs(SCHEDULER_NULL_POINTER, stderr);
+        return 1;
+    } else if (!array) {
+        fputs(CONTAINER_NULL_POINTER, stderr);
+        return 1;
+    } else if (!parse) {
+        fputs(NULL_PARSER_POINTER, stderr);
+        return 1;
+    }
+
+    LoaderJob job = { record_size, array->elem_size, parse, NULL, ctx, 0 };
+    int old_num_elem = array->num_elem;
+
+    if (!loader_run(sched, fd, &job, array->destroy, append_to_array, array))
+        return 0;
+
+    /* The elements of the chunks appended before the failure go too */
+    char * elem = (char *) array->list + (size_t) old_num_elem * array->elem_size;
+    if (array->destroy)
+        for (int i = old_num_elem; i < array->num_elem; i++, elem += array->elem_size)
+            array->destroy(elem);
+    array->num_elem = old_num_elem;
+    if (array->filter)
+        bloom_invalidate(array->filter);
+    return 1;
+}
+
+int loader_append_list(Scheduler * sched, int fd, size_t record_size, List * list,
+                       void * (*parse)(const char * record, size_t len, void * ctx), void * ctx) {
+    if (!sched) {
+        fputs(SCHEDULER_NULL_POINTER, stderr);
+        return 1;
+    } else if (!list) {
+        fputs(CONTAINER_NULL_POINTER, stderr);
+        return 1;
+    } else if (!parse) {
+        fputs(NULL_PARSER_POINTER, stderr);
+        return 1;
+    }
+
+    LoaderJob job = { record_size, sizeof(void *), NULL, parse, ctx, 0 };
+    ListNode * old_tail = list_tail(list);
+
+    if (!loader_run(sched, fd, &job, list->destroy, append_to_list, list))
+        return 0;
+
+    /* The nodes appended before the failure are removed, which destroys their
+     * data and frees their blocks as they empty */
+    while (old_tail->next != NULL)
+        list_remove_next(list, old_tail);
+    return 1;
+}
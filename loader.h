@@ -0,0 +1,88 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <stddef.h>
+#include "array.h"
+#include "linked_list.h"
+#include "scheduler.h"
+
+/**
+ * @file loader.h
+ * @brief Parallel loading of Arrays and Lists from large record files.
+ *
+ * A file is read in large chunks and split into records at chunk boundaries:
+ * either lines ended by '\n' or fixed length binary records. Each chunk is
+ * parsed by a task on a Scheduler, record by record, with a user callback,
+ * while the calling thread goes on reading the next chunks. Parsed chunks are
+ * appended to the target container in file order, each one in a single bulk
+ * append, so the result is the same as parsing the file sequentially.
+ *
+ * Only a bounded number of chunks is in flight at a time, so memory use
+ * doesn't depend on the size of the file. Regular files are read with pread
+ * and the kernel is told the access is sequential, so it reads ahead. Other
+ * descriptors, such as pipes, are read with read.
+ *
+ * Records are handed to the parser without their '\n', and a last line with
+ * no '\n' is a record too. Lines may be longer than a chunk. A file whose size
+ * isn't a multiple of the record size is invalid in fixed record mode.
+ *
+ * Records of a single chunk are parsed in order by one thread, but different
+ * chunks are parsed concurrently, so the parser must be safe to call from
+ * several threads at once with the same ctx.
+ */
+
+/**
+ * @brief Record size selecting newline delimited records
+ */
+#define LOADER_LINES 0
+
+/**
+ * @brief Loads the records of a file at the end of an Array
+ *
+ * The parser has the prototype
+ *
+ *      int parse(const char *record, size_t len, void *out, void *ctx);
+ *
+ * It must write the element built from the len bytes at record to out, which
+ * has room for elem_size bytes, and return 0, or return 1 on failure, which
+ * aborts the load.
+ *
+ * @param sched Scheduler running the parsers
+ *
+ * @param fd Descriptor read from its current position to the end of file.
+ *           On success, regular files are left positioned at the end.
+ *
+ * @param record_size Length in bytes of each record, or LOADER_LINES
+ *
+ * @param array Array the elements are appended to
+ *
+ * @param parse The record parser
+ *
+ * @param ctx User context given to parse
+ *
+ * @return 0 if the whole file was loaded, 1 otherwise, in which case the array
+ *         is left with the elements it had, the new ones being destroyed.
+ */
+int loader_append_array(Scheduler * sched, int fd, size_t record_size, Array * array,
+                        int (*parse)(const char * record, size_t len, void * out, void * ctx), void * ctx);
+
+/**
+ * @brief Loads the records of a file at the end of a List
+ *
+ * The parser has the prototype
+ *
+ *      void *parse(const char *record, size_t len, void *ctx);
+ *
+ * It must build an element from the len bytes at record and return a pointer
+ * to it, or NULL on failure, which aborts the load. Chunks are appended with
+ * list_append_n, so each one gets its nodes in a single block.
+ *
+ * @return 0 if the whole file was loaded, 1 otherwise, in which case the list
+ *         is left with the elements it had, the new ones being destroyed.
+ *
+ * See loader_append_array for the other parameters.
+ */
+int loader_append_list(Scheduler * sched, int fd, size_t record_size, List * list,
+                       void * (*parse)(const char * record, size_t len, void * ctx), void * ctx);
+
+#endif
@@ -0,0 +1,213 @@
+#include "lru_cache.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+#define LRU_ALLOCATION_ERROR "Error in memory allocation for lru cache\n"
+
+#define LRU_ENTRY_ALLOCATION_ERROR "Error in memory allocation for lru cache entry\n"
+
+#define NULL_LRU_POINTER "Lru cache pointer is null\n"
+
+#define NULL_HASH_OR_COMPARE "Param hash or compare is null\n"
+
+#define LRU_INITIAL_BUCKETS 64
+
+/* Destroy function of the recency list, so every way an entry leaves the list
+ * goes through the user destroy hook */
+static void entry_release(void * data) {
+    LruEntry * entry = data;
+
+    entry->cache->bytes -= entry->bytes;
+    if (entry->cache->destroy)
+        entry->cache->destroy(entry->value);
+    free(entry);
+}
+
+LruCache * lru_init(int max_entries, size_t max_bytes, uint64_t (*hash)(void * key),
+                    int (*compare)(void * a, void * b), void (*destroy)(void * value)) {
+    if (!hash || !compare) {
+        fputs(NULL_HASH_OR_COMPARE, stderr);
+        return NULL;
+    }
+
+    LruCache * cache = malloc(sizeof(LruCache));
+    if (!cache) {
+        fputs(LRU_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    cache->buckets = calloc(LRU_INITIAL_BUCKETS, sizeof(LruEntry *));
+    if (!cache->buckets) {
+        fputs(LRU_ALLOCATION_ERROR, stderr);
+        free(cache);
+        return NULL;
+    }
+
+    cache->recency = dlist_init(entry_release);
+    if (!cache->recency) {
+        free(cache->buckets);
+        free(cache);
+        return NULL;
+    }
+
+    cache->num_buckets = LRU_INITIAL_BUCKETS;
+    cache->max_entries = max_entries > 0 ? max_entries : 0;
+    cache->max_bytes = max_bytes;
+    cache->bytes = 0;
+    cache->hash = hash;
+    cache->compare = compare;
+    cache->destroy = destroy;
+    cache->hits = cache->misses = cache->evictions = 0;
+
+    return cache;
+}
+
+void lru_terminate(LruCache * cache) {
+    if (!cache) {
+        fputs(NULL_LRU_POINTER, stderr);
+        return;
+    }
+
+    dlist_terminate(cache->recency);
+    free(cache->buckets);
+    free(cache);
+}
+
+/* Returns the link pointing to the entry of key, or to the NULL ending its bucket */
+static LruEntry ** find_link(LruCache * cache, void * key, uint64_t hash) {
+    LruEntry ** link = &cache->buckets[hash & (cache->num_buckets - 1)];
+
+    while (*link && ((*link)->hash != hash || cache->compare((*link)->key, key) != 0))
+        link = &(*link)->hash_next;
+
+    return link;
+}
+
+static void unlink_hash(LruCache * cache, LruEntry * entry) {
+    LruEntry ** link = &cache->buckets[entry->hash & (cache->num_buckets - 1)];
+
+    while (*link != entry)
+        link = &(*link)->hash_next;
+    *link = entry->hash_next;
+}
+
+/* Doubles the bucket array. On allocation failure the table keeps working, just
+ * with longer chains. */
+static void grow_buckets(LruCache * cache) {
+    size_t num_buckets = cache->num_buckets * 2;
+    LruEntry ** buckets = calloc(num_buckets, sizeof(LruEntry *));
+    if (!buckets)
+        return;
+
+    for (size_t i = 0; i < cache->num_buckets; i++) {
+        LruEntry * entry = cache->buckets[i];
+        while (entry) {
+            LruEntry * next = entry->hash_next;
+            LruEntry ** bucket = &buckets[entry->hash & (num_buckets - 1)];
+            entry->hash_next = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->num_buckets = num_buckets;
+}
+
+/* Unlinks an entry from the hash table and the recency list, destroying it */
+static void remove_entry(LruCache * cache, LruEntry * entry) {
+    unlink_hash(cache, entry);
+    delist_remove_next(cache->recency, entry->node->prev);
+}
+
+static int over_limits(LruCache * cache) {
+    return (cache->max_entries && lru_num_entries(cache) > cache->max_entries)
+        || (cache->max_bytes && cache->bytes > cache->max_bytes);
+}
+
+void * lru_get(LruCache * cache, void * key) {
+    if (!cache) {
+        fputs(NULL_LRU_POINTER, stderr);
+        return NULL;
+    }
+
+    LruEntry * entry = *find_link(cache, key, cache->hash(key));
+
+    if (!entry) {
+        cache->misses++;
+        return NULL;
+    }
+
+    cache->hits++;
+    dlist_move_first(cache->recency, entry->node);
+    return entry->value;
+}
+
+int lru_put(LruCache * cache, void * key, void * value, size_t bytes) {
+    if (!cache) {
+        fputs(NULL_LRU_POINTER, stderr);
+        return 1;
+    }
+
+    uint64_t hash = cache->hash(key);
+    LruEntry * entry = *find_link(cache, key, hash);
+
+    if (entry) {
+        if (cache->destroy && entry->value != value)
+            cache->destroy(entry->value);
+        cache->bytes = cache->bytes - entry->bytes + bytes;
+        entry->key = key;
+        entry->value = value;
+        entry->bytes = bytes;
+        dlist_move_first(cache->recency, entry->node);
+    } else {
+        entry = malloc(sizeof(LruEntry));
+        if (!entry) {
+            fputs(LRU_ENTRY_ALLOCATION_ERROR, stderr);
+            return 1;
+        }
+
+        entry->key = key;
+        entry->value = value;
+        entry->bytes = bytes;
+        entry->hash = hash;
+        entry->cache = cache;
+
+        if ((size_t) lru_num_entries(cache) >= cache->num_buckets)
+            grow_buckets(cache);
+
+        LruEntry ** bucket = &cache->buckets[hash & (cache->num_buckets - 1)];
+        entry->hash_next = *bucket;
+        *bucket = entry;
+
+        if (dlist_insert_next(cache->recency, dlist_head(cache->recency), entry)) {
+            *bucket = entry->hash_next;
+            free(entry);
+            return 1;
+        }
+        entry->node = dlist_head(cache->recency)->next;
+        cache->bytes += bytes;
+    }
+
+    while (lru_num_entries(cache) > 0 && over_limits(cache)) {
+        remove_entry(cache, dlist_head(cache->recency)->prev->data);
+        cache->evictions++;
+    }
+
+    return 0;
+}
+
+int lru_remove(LruCache * cache, void * key) {
+    if (!cache) {
+        fputs(NULL_LRU_POINTER, stderr);
+        return 1;
+    }
+
+    LruEntry * entry = *find_link(cache, key, cache->hash(key));
+    if (!entry)
+        return 1;
+
+    remove_entry(cache, entry);
+    return 0;
+}
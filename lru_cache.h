@@ -0,0 +1,131 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dlist.h"
+
+/**
+ * @file lru_cache.h
+ * @brief Least recently used cache with O(1) get, put and eviction.
+ *
+ * Entries are kept in a Dlist ordered from the most recently used to the least
+ * recently used one, and a hash table maps each key to its Dlist node. A hit
+ * moves the node to the front of the list, and evictions take the node at the
+ * back, so no operation needs to scan the list.
+ *
+ * The cache can be bounded by number of entries, by bytes, or both. The bytes
+ * of an entry are whatever the user says they are when putting it.
+ *
+ * Keys are not copied. A key must stay valid while its entry is in the cache,
+ * which is easiest to ensure by pointing it into the value itself.
+ */
+
+/**
+ * @brief An entry of the cache.
+ */
+typedef struct LruEntry {
+    void * key;                     /**< Key of the entry. */
+    void * value;                   /**< Value of the entry. */
+    size_t bytes;                   /**< Size accounted for the entry. */
+    uint64_t hash;                  /**< Cached hash of the key. */
+    DlistNode * node;               /**< Node of the entry in the recency list. */
+    struct LruEntry * hash_next;    /**< Next entry in the same hash bucket. */
+    struct LruCache * cache;        /**< Cache owning the entry. */
+} LruEntry;
+
+/**
+ * @brief The cache structure.
+ */
+typedef struct LruCache {
+    Dlist * recency;                /**< Entries from the most to the least recently used. */
+    LruEntry ** buckets;            /**< Hash table buckets. */
+    size_t num_buckets;             /**< Number of buckets, always a power of two. */
+    int max_entries;                /**< Maximum number of entries, 0 for no limit. */
+    size_t max_bytes;               /**< Maximum number of bytes, 0 for no limit. */
+    size_t bytes;                   /**< Bytes currently accounted. */
+    uint64_t (*hash)(void * key);   /**< Hash function for keys. */
+    int (*compare)(void * a, void * b); /**< Key comparison function. */
+    void (*destroy)(void * value);  /**< Value destructor, may be NULL. */
+    uint64_t hits;                  /**< Number of lru_get calls that found the key. */
+    uint64_t misses;                /**< Number of lru_get calls that didn't find the key. */
+    uint64_t evictions;             /**< Number of entries evicted to honor the limits. */
+} LruCache;
+
+/**
+ * @brief Initializes a new cache.
+ *
+ * @param max_entries Maximum number of entries. 0 means no limit.
+ * @param max_bytes Maximum total bytes of the entries. 0 means no limit.
+ * @param hash Hash function for keys. Keys that compare equal must have the same hash.
+ * @param compare Key comparison function, analogue to strcmp() from string.h. Only
+ *                equality matters.
+ * @param destroy Function used to free values when they are evicted, removed or
+ *                replaced, and when the cache is terminated. Can be NULL.
+ *
+ * @return A pointer to the new cache, or NULL if memory allocation fails.
+ */
+LruCache * lru_init(int max_entries, size_t max_bytes, uint64_t (*hash)(void * key),
+                    int (*compare)(void * a, void * b), void (*destroy)(void * value));
+
+/**
+ * @brief Destroys the cache, calling destroy on every value still cached.
+ *
+ * @param cache Pointer to the cache.
+ */
+void lru_terminate(LruCache * cache);
+
+/**
+ * @brief Looks a key up and marks its entry as the most recently used.
+ *
+ * @param cache Pointer to the cache.
+ * @param key The key to look for.
+ *
+ * @return The value of the key, or NULL if it isn't cached.
+ */
+void * lru_get(LruCache * cache, void * key);
+
+/**
+ * @brief Inserts or replaces an entry and marks it as the most recently used.
+ *
+ * If the key is already cached, its old value is destroyed and replaced. Then the
+ * least recently used entries are evicted until the cache fits its limits, which
+ * evicts the new entry too if it is larger than max_bytes on its own.
+ *
+ * @param cache Pointer to the cache.
+ * @param key The key of the entry.
+ * @param value The value of the entry. The cache takes ownership of it.
+ * @param bytes Size accounted for the entry against max_bytes.
+ *
+ * @return 0 if the entry was inserted, 1 otherwise.
+ */
+int lru_put(LruCache * cache, void * key, void * value, size_t bytes);
+
+/**
+ * @brief Removes an entry, destroying its value.
+ *
+ * @param cache Pointer to the cache.
+ * @param key The key of the entry.
+ *
+ * @return 0 if the entry was removed, 1 if the key isn't cached.
+ */
+int lru_remove(LruCache * cache, void * key);
+
+/**
+ * Macro to access the number of entries in the cache.
+ */
+#define lru_num_entries(cache) dlist_num_elem((cache)->recency)
+
+/**
+ * Macro to access the bytes accounted by the cache.
+ */
+#define lru_bytes(cache) ((cache)->bytes)
+
+/**
+ * Macros to access the hit, miss and eviction counters.
+ */
+#define lru_hits(cache) ((cache)->hits)
+#define lru_misses(cache) ((cache)->misses)
+#define lru_evictions(cache) ((cache)->evictions)
+
+#endif
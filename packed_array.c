@@ -0,0 +1,499 @@
+#include "packed_array.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PACKED_X86 1
+#include <immintrin.h>
+#endif
+
+#define PACKED_ALLOCATION_ERROR "Memory allocation error for the packed array\n"
+
+#define PACKED_NULL_POINTER "Packed array pointer parameter is NULL\n"
+
+#define NULL_VALUES_POINTER "Values pointer parameter is NULL\n"
+
+#define VALUES_NOT_SORTED "Values are not sorted in non decreasing order\n"
+
+#define ARRAY_NULL_POINTER "Array pointer parameter is NULL\n"
+
+#define ELEM_SIZE_MISMATCH "Array elem_size is not 8\n"
+
+#define CURSOR_NULL_POINTER "Cursor pointer parameter is NULL\n"
+
+#define PACKED_LANES 4
+
+/* Values per lane in a block */
+#define LANE_SLOTS (PACKED_BLOCK_SIZE / PACKED_LANES)
+
+/* Each lane takes LANE_SLOTS * width bits, rounded up to whole words */
+#define BLOCK_WORDS(width) ((size_t) PACKED_LANES * (((width) * LANE_SLOTS + 63) / 64))
+
+#define WIDTH_MASK(width) ((width) == 64 ? ~0ULL : (1ULL << (width)) - 1)
+
+/* ---------------------------------------------------------------------------
+ * Block packing. Value i of a block sits in lane i % 4 at slot i / 4, and
+ * slot s of a lane starts at bit s * width of the lane. Word t of lane l is
+ * stored at words[t * 4 + l], so the four lanes share each shift, and the
+ * four values unpacked together are consecutive.
+ *
+ * Decoding reads the word after the one a slot starts in even when the slot
+ * doesn't spill into it, to stay branch free; the bits it brings are masked
+ * away. The data buffer has PACKED_LANES words of padding for the last block.
+ * ------------------------------------------------------------------------- */
+
+static void pack_block(const uint64_t * deltas, int width, uint64_t * words) {
+    if (width == 0)
+        return;
+
+    for (int i = 0; i < PACKED_BLOCK_SIZE; i++) {
+        size_t bit = (size_t) (i / PACKED_LANES) * width;
+        size_t t = bit / 64;
+        int shift = (int) (bit % 64);
+        int lane = i % PACKED_LANES;
+
+        words[t * PACKED_LANES + lane] |= deltas[i] << shift;
+        if (shift + width > 64)
+            words[(t + 1) * PACKED_LANES + lane] |= deltas[i] >> (64 - shift);
+    }
+}
+
+/* Unpacks the differences of a block and turns them into values, the first
+ * one being the head */
+static void decode_scalar(const uint64_t * words, int width, uint64_t head, uint64_t * out) {
+    uint64_t mask = WIDTH_MASK(width);
+    uint64_t acc = head;
+
+    for (int slot = 0; slot < LANE_SLOTS; slot++) {
+        size_t bit = (size_t) slot * width;
+        const uint64_t * w = words + bit / 64 * PACKED_LANES;
+        int shift = (int) (bit % 64);
+
+        for (int lane = 0; lane < PACKED_LANES; lane++) {
+            uint64_t spill = shift ? w[lane + PACKED_LANES] << (64 - shift) : 0;
+            acc += ((w[lane] >> shift) | spill) & mask;
+            out[slot * PACKED_LANES + lane] = acc;
+        }
+    }
+}
+
+#ifdef PACKED_X86
+
+#define AVX2 __attribute__((target("avx2")))
+
+/* One vector holds the same word of the four lanes, which unpacks into four
+ * consecutive differences. Vector shifts by 64 give 0, as needed for shift 0.
+ * The prefix sum adds each vector to itself moved one and two lanes up, then
+ * the last value of the previous vector. */
+AVX2 static void decode_avx2(const uint64_t * words, int width, uint64_t head, uint64_t * out) {
+    const __m256i mask = _mm256_set1_epi64x((long long) WIDTH_MASK(width));
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i carry = _mm256_set1_epi64x((long long) head);
+
+    for (int slot = 0; slot < LANE_SLOTS; slot++) {
+        size_t bit = (size_t) slot * width;
+        const uint64_t * w = words + bit / 64 * PACKED_LANES;
+        int shift = (int) (bit % 64);
+
+        __m256i lo = _mm256_srl_epi64(_mm256_loadu_si256((const __m256i *) w), _mm_cvtsi32_si128(shift));
+        __m256i hi = _mm256_sll_epi64(_mm256_loadu_si256((const __m256i *) (w + PACKED_LANES)),
+                                      _mm_cvtsi32_si128(64 - shift));
+        __m256i v = _mm256_and_si256(_mm256_or_si256(lo, hi), mask);
+
+        v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03));
+        v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F));
+        v = _mm256_add_epi64(v, carry);
+        carry = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+
+        _mm256_storeu_si256((__m256i *) (out + slot * PACKED_LANES), v);
+    }
+}
+
+#endif /* PACKED_X86 */
+
+typedef void (*decode_kernel)(const uint64_t * words, int width, uint64_t head, uint64_t * out);
+
+static decode_kernel select_decode(void) {
+#ifdef PACKED_X86
+    if (__builtin_cpu_supports("avx2"))
+        return decode_avx2;
+#endif
+    return decode_scalar;
+}
+
+/* ------------------------------------------------------------------------- */
+
+PackedArray * packed_array_init(const uint64_t * values, int n) {
+    if (!values && n > 0) {
+        fputs(NULL_VALUES_POINTER, stderr);
+        return NULL;
+    }
+
+    if (n < 0)
+        n = 0;
+
+    for (int i = 1; i < n; i++) {
+        if (values[i] < values[i - 1]) {
+            fputs(VALUES_NOT_SORTED, stderr);
+            return NULL;
+        }
+    }
+
+    PackedArray * packed = malloc(sizeof(PackedArray));
+    if (!packed) {
+        fputs(PACKED_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    int num_blocks = (int) (((size_t) n + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE);
+
+    packed->num_elem = n;
+    packed->num_blocks = num_blocks;
+    packed->heads = malloc((size_t) num_blocks * sizeof(uint64_t));
+    packed->offsets = malloc((size_t) num_blocks * sizeof(size_t));
+    packed->widths = malloc((size_t) num_blocks);
+    packed->data = NULL;
+    packed->num_words = 0;
+
+    if (num_blocks > 0 && (!packed->heads || !packed->offsets || !packed->widths)) {
+        fputs(PACKED_ALLOCATION_ERROR, stderr);
+        packed_array_terminate(packed);
+        return NULL;
+    }
+
+    /* First pass: the width of each block gives where the next one starts */
+    for (int b = 0; b < num_blocks; b++) {
+        int first = b * PACKED_BLOCK_SIZE;
+        int last = first + PACKED_BLOCK_SIZE < n ? first + PACKED_BLOCK_SIZE : n;
+        uint64_t max_delta = 0;
+
+        for (int i = first + 1; i < last; i++)
+            if (values[i] - values[i - 1] > max_delta)
+                max_delta = values[i] - values[i - 1];
+
+        packed->heads[b] = values[first];
+        packed->widths[b] = (uint8_t) (max_delta ? 64 - __builtin_clzll(max_delta) : 0);
+        packed->offsets[b] = packed->num_words;
+        packed->num_words += BLOCK_WORDS(packed->widths[b]);
+    }
+
+    if (packed->num_words > 0) {
+        packed->data = calloc(packed->num_words + PACKED_LANES, sizeof(uint64_t));
+        if (!packed->data) {
+            fputs(PACKED_ALLOCATION_ERROR, stderr);
+            packed_array_terminate(packed);
+            return NULL;
+        }
+    }
+
+    /* Second pass: the differences, 0 for the head and past the last value */
+    uint64_t deltas[PACKED_BLOCK_SIZE];
+
+    for (int b = 0; b < num_blocks; b++) {
+        int first = b * PACKED_BLOCK_SIZE;
+        int count = n - first < PACKED_BLOCK_SIZE ? n - first : PACKED_BLOCK_SIZE;
+
+        deltas[0] = 0;
+        for (int i = 1; i < count; i++)
+            deltas[i] = values[first + i] - values[first + i - 1];
+        for (int i = count > 0 ? count : 1; i < PACKED_BLOCK_SIZE; i++)
+            deltas[i] = 0;
+
+        pack_block(deltas, packed->widths[b], packed->data + packed->offsets[b]);
+    }
+
+    return packed;
+}
+
+PackedArray * packed_array_from_array(Array * array) {
+    if (!array) {
+        fputs(ARRAY_NULL_POINTER, stderr);
+        return NULL;
+    } else if (array->elem_size != sizeof(uint64_t)) {
+        fputs(ELEM_SIZE_MISMATCH, stderr);
+        return NULL;
+    }
+
+    return packed_array_init(array->list, array->num_elem);
+}
+
+void packed_array_terminate(PackedArray * packed) {
+    if (!packed) {
+        fputs(PACKED_NULL_POINTER, stderr);
+        return;
+    }
+
+    free(packed->heads);
+    free(packed->offsets);
+    free(packed->widths);
+    free(packed->data);
+    free(packed);
+}
+
+/* Decodes a block known to exist and returns how many values it holds */
+static int decode_block(const PackedArray * packed, int block, uint64_t * out) {
+    int width = packed->widths[block];
+    uint64_t head = packed->heads[block];
+
+    if (width == 0) {
+        for (int i = 0; i < PACKED_BLOCK_SIZE; i++)
+            out[i] = head;
+    } else {
+        select_decode()(packed->data + packed->offsets[block], width, head, out);
+    }
+
+    int first = block * PACKED_BLOCK_SIZE;
+    return packed->num_elem - first < PACKED_BLOCK_SIZE ? packed->num_elem - first : PACKED_BLOCK_SIZE;
+}
+
+int packed_array_decode_block(const PackedArray * packed, int block, uint64_t * out) {
+    if (!packed) {
+        fputs(PACKED_NULL_POINTER, stderr);
+        return -1;
+    } else if (!out) {
+        fputs(NULL_VALUES_POINTER, stderr);
+        return -1;
+    } else if (block < 0 || block >= packed->num_blocks) {
+        return -1;
+    }
+
+    return decode_block(packed, block, out);
+}
+
+Array * packed_array_to_array(const PackedArray * packed) {
+    if (!packed) {
+        fputs(PACKED_NULL_POINTER, stderr);
+        return NULL;
+    }
+
+    Array * array = array_init(NULL, packed->num_elem, sizeof(uint64_t));
+    if (!array)
+        return NULL;
+
+    uint64_t * out = array->list;
+    uint64_t buffer[PACKED_BLOCK_SIZE];
+
+    /* Full blocks decode in place; the last one may be short */
+    for (int b = 0; b < packed->num_blocks; b++) {
+        uint64_t * dst = out + (size_t) b * PACKED_BLOCK_SIZE;
+        if (b < packed->num_blocks - 1) {
+            decode_block(packed, b, dst);
+        } else {
+            int count = decode_block(packed, b, buffer);
+            memcpy(dst, buffer, (size_t) count * sizeof(uint64_t));
+        }
+    }
+
+    array->num_elem = packed->num_elem;
+    return array;
+}
+
+int packed_array_get(const PackedArray * packed, int index, uint64_t * value) {
+    if (!packed) {
+        fputs(PACKED_NULL_POINTER, stderr);
+        return 1;
+    } else if (index < 0 || index >= packed->num_elem) {
+        return 1;
+    }
+
+    uint64_t buffer[PACKED_BLOCK_SIZE];
+    decode_block(packed, index / PACKED_BLOCK_SIZE, buffer);
+    *value = buffer[index % PACKED_BLOCK_SIZE];
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * Cursors. pos is the current value, the last one returned, and it's equal to
+ * count once the array is exhausted.
+ * ------------------------------------------------------------------------- */
+
+void packed_cursor_init(PackedCursor * cursor, const PackedArray * packed) {
+    if (!cursor) {
+        fputs(CURSOR_NULL_POINTER, stderr);
+        return;
+    }
+
+    cursor->array = packed;
+    cursor->block = -1;
+    cursor->pos = 0;
+    cursor->count = 0;
+}
+
+/* Decodes a block and moves to its first value. Returns 1 past the last
+ * block, leaving the cursor exhausted. */
+static int cursor_load(PackedCursor * cursor, int block) {
+    if (block >= cursor->array->num_blocks) {
+        cursor->pos = cursor->count;
+        return 1;
+    }
+
+    cursor->count = decode_block(cursor->array, block, cursor->values);
+    cursor->block = block;
+    cursor->pos = 0;
+    return 0;
+}
+
+int packed_cursor_next(PackedCursor * cursor, uint64_t * value) {
+    if (!cursor || !cursor->array) {
+        fputs(CURSOR_NULL_POINTER, stderr);
+        return 1;
+    }
+
+    if (cursor->block < 0) {
+        if (cursor_load(cursor, 0))
+            return 1;
+    } else if (cursor->pos >= cursor->count || ++cursor->pos == cursor->count) {
+        if (cursor_load(cursor, cursor->block + 1))
+            return 1;
+    }
+
+    *value = cursor->values[cursor->pos];
+    return 0;
+}
+
+/* Last block from lo on whose head is not greater than target, found by
+ * galloping and then binary search. heads[lo] must not be greater. */
+static int skip_blocks(const PackedArray * packed, int lo, uint64_t target) {
+    const uint64_t * heads = packed->heads;
+    int n = packed->num_blocks;
+    int step = 1;
+
+    while (lo + step < n && heads[lo + step] <= target) {
+        lo += step;
+        step *= 2;
+    }
+
+    int hi = lo + step < n ? lo + step : n;     /* first head known greater, or n */
+
+    while (hi - lo > 1) {
+        int mid = lo + (hi - lo) / 2;
+        if (heads[mid] <= target)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+int packed_cursor_next_geq(PackedCursor * cursor, uint64_t target, uint64_t * value) {
+    if (!cursor || !cursor->array) {
+        fputs(CURSOR_NULL_POINTER, stderr);
+        return 1;
+    }
+
+    const PackedArray * packed = cursor->array;
+
+    if (cursor->block < 0 && cursor_load(cursor, 0))
+        return 1;
+    if (cursor->pos >= cursor->count)
+        return 1;
+
+    if (cursor->values[cursor->count - 1] < target) {
+        int next = cursor->block + 1;
+
+        if (next >= packed->num_blocks) {
+            cursor->pos = cursor->count;
+            return 1;
+        }
+
+        /* Every value of the block before the last head not greater than
+         * target is smaller than it */
+        if (packed->heads[next] <= target)
+            next = skip_blocks(packed, next, target);
+        cursor_load(cursor, next);
+
+        if (cursor->values[cursor->count - 1] < target && cursor_load(cursor, next + 1))
+            return 1;
+    }
+
+    while (cursor->values[cursor->pos] < target)
+        cursor->pos++;
+
+    *value = cursor->values[cursor->pos];
+    return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+Array * packed_array_intersect(const PackedArray * a, const PackedArray * b) {
+    if (!a || !b) {
+        fputs(PACKED_NULL_POINTER, stderr);
+        return NULL;
+    }
+
+    if (a->num_elem > b->num_elem) {
+        const PackedArray * t = a;
+        a = b;
+        b = t;
+    }
+
+    Array * result = array_init(NULL, a->num_elem, sizeof(uint64_t));
+    if (!result)
+        return NULL;
+
+    uint64_t * out = result->list;
+    int num_out = 0;
+    PackedCursor small, large;
+    uint64_t x, y;
+
+    packed_cursor_init(&small, a);
+    packed_cursor_init(&large, b);
+
+    while (!packed_cursor_next(&small, &x)) {
+        if (packed_cursor_next_geq(&large, x, &y))
+            break;
+        if (y == x && (num_out == 0 || out[num_out - 1] != x))
+            out[num_out++] = x;
+    }
+
+    result->num_elem = num_out;
+    return result;
+}
+
+Array * packed_array_union(const PackedArray * a, const PackedArray * b) {
+    if (!a || !b) {
+        fputs(PACKED_NULL_POINTER, stderr);
+        return NULL;
+    }
+
+    size_t total = (size_t) a->num_elem + (size_t) b->num_elem;
+    if (total > INT32_MAX) {
+        fputs(PACKED_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    Array * result = array_init(NULL, (int) total, sizeof(uint64_t));
+    if (!result)
+        return NULL;
+
+    uint64_t * out = result->list;
+    int num_out = 0;
+    PackedCursor ca, cb;
+    uint64_t x, y;
+
+    packed_cursor_init(&ca, a);
+    packed_cursor_init(&cb, b);
+
+    int has_x = !packed_cursor_next(&ca, &x);
+    int has_y = !packed_cursor_next(&cb, &y);
+
+    while (has_x || has_y) {
+        uint64_t v;
+
+        if (has_x && (!has_y || x <= y)) {
+            v = x;
+            has_x = !packed_cursor_next(&ca, &x);
+        } else {
+            v = y;
+            has_y = !packed_cursor_next(&cb, &y);
+        }
+
+        if (num_out == 0 || out[num_out - 1] != v)
+            out[num_out++] = v;
+    }
+
+    result->num_elem = num_out;
+    return result;
+}
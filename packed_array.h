@@ -0,0 +1,178 @@
+#ifndef PACKED_ARRAY_H
+#define PACKED_ARRAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "array.h"
+
+/**
+ * @file packed_array.h
+ * @brief Compressed read-only array of sorted 64 bits unsigned integers.
+ *
+ * The values are split in blocks of 128. Each block keeps its first value in
+ * a skip index, the block heads, and stores the differences between
+ * consecutive values bit-packed with the smallest width that fits the largest
+ * one. Dense sorted sets, such as posting lists of document IDs, take a few
+ * bits per value instead of 64.
+ *
+ * Inside a block, value i goes to lane i % 4 and the four lanes are packed
+ * side by side, one 64 bits word of each lane after the other. All lanes then
+ * unpack with the same shifts, four values at a time. On x86 processors that
+ * support it, blocks are decoded with AVX2 instructions, chosen at run time;
+ * elsewhere a portable loop is used.
+ *
+ * Searches go through the block heads first, so only the block that may hold
+ * the value is decoded.
+ */
+
+/**
+ * @brief Number of values per block
+ */
+#define PACKED_BLOCK_SIZE 128
+
+/**
+ * @brief The compressed array structure
+ */
+typedef struct PackedArray {
+    uint64_t * heads;               //first value of each block, the skip index
+    size_t * offsets;               //position in words of each block inside data
+    uint8_t * widths;               //bits per difference in each block
+    uint64_t * data;                //packed differences of all the blocks
+    size_t num_words;               //length of data in words
+    int num_elem;                   //number of values
+    int num_blocks;                 //number of blocks
+} PackedArray;
+
+/**
+ * @brief Position of a sequential reader over a PackedArray
+ *
+ * It holds the decoded block it's in, so moving forward only decodes each
+ * block once.
+ */
+typedef struct PackedCursor {
+    const PackedArray * array;      //array being read
+    int block;                      //decoded block, -1 before the first
+    int pos;                        //position of the current value inside the block
+    int count;                      //number of values in the decoded block
+    uint64_t values[PACKED_BLOCK_SIZE]; //the decoded block
+} PackedCursor;
+
+/**
+ * @brief Compresses an array of sorted 64 bits unsigned integers
+ *
+ * @param values The values, in non decreasing order
+ *
+ * @param n Number of values
+ *
+ * @return A pointer to the new compressed array, or NULL if the values are not
+ *         sorted or memory allocation fails.
+ */
+PackedArray * packed_array_init(const uint64_t * values, int n);
+
+/**
+ * @brief Compresses an Array of sorted 64 bits unsigned integers
+ *
+ * @param array Array with elem_size 8 holding uint64_t values in non
+ *              decreasing order. It's left untouched.
+ *
+ * @return A pointer to the new compressed array, or NULL on error.
+ */
+PackedArray * packed_array_from_array(Array * array);
+
+/**
+ * @brief Destroys the compressed array
+ */
+void packed_array_terminate(PackedArray * packed);
+
+/**
+ * @brief Decompresses one block
+ *
+ * @param packed Pointer to the compressed array
+ *
+ * @param block Index of the block, from 0 to num_blocks - 1
+ *
+ * @param out Room for PACKED_BLOCK_SIZE values
+ *
+ * @return The number of values written, or -1 if the parameters are invalid.
+ */
+int packed_array_decode_block(const PackedArray * packed, int block, uint64_t * out);
+
+/**
+ * @brief Decompresses the whole array into a new Array of uint64_t
+ *
+ * @return A pointer to the new Array, or NULL on error.
+ */
+Array * packed_array_to_array(const PackedArray * packed);
+
+/**
+ * @brief Value at a given index
+ *
+ * It decodes the block holding it; use a cursor to read many values.
+ *
+ * @param value Where the value is written
+ *
+ * @return 0 on success, 1 if the index is out of range.
+ */
+int packed_array_get(const PackedArray * packed, int index, uint64_t * value);
+
+/**
+ * @brief Starts a cursor before the first value of the array
+ */
+void packed_cursor_init(PackedCursor * cursor, const PackedArray * packed);
+
+/**
+ * @brief Moves the cursor to the next value
+ *
+ * @param value Where the value is written
+ *
+ * @return 0 on success, 1 once the array is exhausted.
+ */
+int packed_cursor_next(PackedCursor * cursor, uint64_t * value);
+
+/**
+ * @brief Moves the cursor forward to the first value not less than target
+ *
+ * The cursor never goes back: the search starts at the current value, or
+ * the first one if the cursor was just initialized. Blocks whose values are
+ * all less than target are skipped through the block heads without being
+ * decoded.
+ *
+ * @param value Where the value found is written
+ *
+ * @return 0 on success, 1 if no value left is greater or equal to target.
+ */
+int packed_cursor_next_geq(PackedCursor * cursor, uint64_t target, uint64_t * value);
+
+/**
+ * @brief Values present in both arrays
+ *
+ * The shorter array is walked and each of its values is searched forward in
+ * the longer one with packed_cursor_next_geq, so blocks of the longer array
+ * with nothing in common are never decoded.
+ *
+ * @return A new Array of the sorted uint64_t values in common, each one once,
+ *         or NULL on error.
+ */
+Array * packed_array_intersect(const PackedArray * a, const PackedArray * b);
+
+/**
+ * @brief Values present in either array
+ *
+ * @return A new Array of the sorted uint64_t values of both arrays, each one
+ *         once, or NULL on error.
+ */
+Array * packed_array_union(const PackedArray * a, const PackedArray * b);
+
+/**
+ * @brief Memory used by the compressed array, in bytes
+ */
+#define packed_array_bytes(packed) \
+    (sizeof(PackedArray) + (packed)->num_words * sizeof(uint64_t) \
+     + (size_t) (packed)->num_blocks * (sizeof(uint64_t) + sizeof(size_t) + sizeof(uint8_t)))
+
+/**
+ * @brief Number of values in the array
+ */
+#define packed_array_num_elem(packed) ((packed)->num_elem)
+
+#endif
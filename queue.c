@@ -1,8 +1,12 @@
 #include "queue.h"
 #include <stdlib.h>
 
-void enqueue(Queue *queue, void *data) {
-    list_insert_next(queue, list_tail(queue), data);
+int enqueue(Queue *queue, void *data) {
+    return list_insert_next(queue, list_tail(queue), data);
+}
+
+int enqueue_n(Queue *queue, void **data, int n) {
+    return list_append_n(queue, data, n);
 }
 
 void dequeue(Queue *queue) {
@@ -26,6 +26,13 @@ typedef List Queue;
  */
 #define queue_init list_init
 
+/**
+ * @brief Initializes a queue whose memory comes from an allocator.
+ * 
+ * Alias for the `list_init_with` function.
+ */
+#define queue_init_with list_init_with
+
 /**
  * @brief Terminates a queue.
  * 
@@ -63,8 +70,22 @@ typedef List Queue;
  * 
  * @param queue Pointer to the queue where the element will be added.
  * @param data Pointer to the data to be added to the queue.
+ * @return 0 if the element was added, 1 otherwise.
+ */
+int enqueue(Queue *queue, void *data);
+
+/**
+ * @brief Enqueues several elements at once.
+ * 
+ * Adds the elements to the back of the queue in the given order. All the nodes are
+ * allocated in a single block, see list_append_n.
+ * 
+ * @param queue Pointer to the queue where the elements will be added.
+ * @param data Array of n pointers to the data to be added.
+ * @param n Number of elements to add.
+ * @return 0 if the elements were added, 1 otherwise.
  */
-void enqueue(Queue *queue, void *data);
+int enqueue_n(Queue *queue, void **data, int n);
 
 /**
  * @brief Dequeues (removes) an element from the front of the queue.
@@ -0,0 +1,255 @@
+#include "rcu_list.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+#define RCU_LIST_ALLOCATION_ERROR "Memory allocation error for the concurrent list\n"
+
+#define NULL_RCU_LIST_POINTER "Concurrent list pointer is null\n"
+
+#define NULL_COMPARE_POINTER "Param compare is null\n"
+
+RcuList * rcu_list_init(void (*destroy)(void * data)) {
+    RcuList * list = malloc(sizeof(RcuList));
+    if (!list) {
+        fputs(RCU_LIST_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    list->domain = epoch_init();
+    if (!list->domain) {
+        free(list);
+        return NULL;
+    }
+
+    atomic_init(&list->first, NULL);
+    atomic_init(&list->num_elem, 0);
+    list->last = NULL;
+    list->destroy = destroy;
+    pthread_mutex_init(&list->write_lock, NULL);
+
+    return list;
+}
+
+void rcu_list_terminate(RcuList * list) {
+    if (!list) {
+        fputs(NULL_RCU_LIST_POINTER, stderr);
+        return;
+    }
+
+    /* Removed nodes first: their reclaim callbacks use the list */
+    epoch_terminate(list->domain);
+
+    RcuNode * node = atomic_load_explicit(&list->first, memory_order_relaxed);
+    while (node) {
+        RcuNode * next = atomic_load_explicit(&node->next, memory_order_relaxed);
+        if (list->destroy)
+            list->destroy(node->data);
+        free(node);
+        node = next;
+    }
+
+    pthread_mutex_destroy(&list->write_lock);
+    free(list);
+}
+
+EpochRecord * rcu_list_register(RcuList * list) {
+    if (!list) {
+        fputs(NULL_RCU_LIST_POINTER, stderr);
+        return NULL;
+    }
+    return epoch_register(list->domain);
+}
+
+void rcu_list_unregister(RcuList * list, EpochRecord * record) {
+    if (!list) {
+        fputs(NULL_RCU_LIST_POINTER, stderr);
+        return;
+    }
+    epoch_unregister(list->domain, record);
+}
+
+void * rcu_list_search(RcuList * list, int (*compare)(void * a, void * b), void * x) {
+    if (!list) {
+        fputs(NULL_RCU_LIST_POINTER, stderr);
+        return NULL;
+    } else if (!compare) {
+        fputs(NULL_COMPARE_POINTER, stderr);
+        return NULL;
+    }
+
+    for (RcuNode * node = rcu_list_first(list); node; node = rcu_node_next(node)) {
+        if (!compare(node->data, x))
+            return node->data;
+    }
+    return NULL;
+}
+
+static RcuNode * node_alloc(void * data, RcuNode * next) {
+    RcuNode * node = malloc(sizeof(RcuNode));
+    if (!node) {
+        fputs(RCU_LIST_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    node->data = data;
+    atomic_init(&node->next, next);
+    return node;
+}
+
+/* Releases a retired node once no reader can reach it */
+static void node_reclaim(void * ptr, void * ctx) {
+    RcuNode * node = ptr;
+    RcuList * list = ctx;
+
+    if (list->destroy)
+        list->destroy(node->data);
+    free(node);
+}
+
+int rcu_list_insert_head(RcuList * list, void * data) {
+    if (!list) {
+        fputs(NULL_RCU_LIST_POINTER, stderr);
+        return 1;
+    }
+
+    pthread_mutex_lock(&list->write_lock);
+
+    RcuNode * first = atomic_load_explicit(&list->first, memory_order_relaxed);
+    RcuNode * node = node_alloc(data, first);
+    if (!node) {
+        pthread_mutex_unlock(&list->write_lock);
+        return 1;
+    }
+
+    /* The node is fully built before it's published */
+    atomic_store_explicit(&list->first, node, memory_order_release);
+    if (!list->last)
+        list->last = node;
+    atomic_fetch_add_explicit(&list->num_elem, 1, memory_order_relaxed);
+
+    pthread_mutex_unlock(&list->write_lock);
+    return 0;
+}
+
+int rcu_list_append(RcuList * list, void * data) {
+    if (!list) {
+        fputs(NULL_RCU_LIST_POINTER, stderr);
+        return 1;
+    }
+
+    RcuNode * node = node_alloc(data, NULL);
+    if (!node)
+        return 1;
+
+    pthread_mutex_lock(&list->write_lock);
+
+    if (list->last)
+        atomic_store_explicit(&list->last->next, node, memory_order_release);
+    else
+        atomic_store_explicit(&list->first, node, memory_order_release);
+    list->last = node;
+    atomic_fetch_add_explicit(&list->num_elem, 1, memory_order_relaxed);
+
+    pthread_mutex_unlock(&list->write_lock);
+    return 0;
+}
+
+/* Finds the first node equal to x and the link pointing to it. Must be called
+ * with the write lock held. */
+static RcuNode * find_locked(RcuList * list, int (*compare)(void * a, void * b), void * x,
+                             _Atomic(RcuNode *) ** link, RcuNode ** prev) {
+    *link = &list->first;
+    *prev = NULL;
+
+    RcuNode * node = atomic_load_explicit(*link, memory_order_relaxed);
+    while (node && compare(node->data, x)) {
+        *prev = node;
+        *link = &node->next;
+        node = atomic_load_explicit(*link, memory_order_relaxed);
+    }
+    return node;
+}
+
+int rcu_list_remove(RcuList * list, int (*compare)(void * a, void * b), void * x) {
+    if (!list) {
+        fputs(NULL_RCU_LIST_POINTER, stderr);
+        return 1;
+    } else if (!compare) {
+        fputs(NULL_COMPARE_POINTER, stderr);
+        return 1;
+    }
+
+    _Atomic(RcuNode *) * link;
+    RcuNode * prev;
+
+    pthread_mutex_lock(&list->write_lock);
+
+    RcuNode * node = find_locked(list, compare, x, &link, &prev);
+    if (!node) {
+        pthread_mutex_unlock(&list->write_lock);
+        return 1;
+    }
+
+    /* The node keeps its next pointer for readers still standing on it */
+    atomic_store_explicit(link, atomic_load_explicit(&node->next, memory_order_relaxed),
+                          memory_order_release);
+    if (list->last == node)
+        list->last = prev;
+    atomic_fetch_sub_explicit(&list->num_elem, 1, memory_order_relaxed);
+
+    pthread_mutex_unlock(&list->write_lock);
+
+    if (epoch_retire(list->domain, node, node_reclaim, list)) {
+        /* Can't defer it: wait for the readers and release it right here */
+        epoch_barrier(list->domain);
+        node_reclaim(node, list);
+    }
+    return 0;
+}
+
+int rcu_list_replace(RcuList * list, int (*compare)(void * a, void * b), void * x, void * data) {
+    if (!list) {
+        fputs(NULL_RCU_LIST_POINTER, stderr);
+        return 1;
+    } else if (!compare) {
+        fputs(NULL_COMPARE_POINTER, stderr);
+        return 1;
+    }
+
+    RcuNode * replacement = node_alloc(data, NULL);
+    if (!replacement)
+        return 1;
+
+    _Atomic(RcuNode *) * link;
+    RcuNode * prev;
+
+    pthread_mutex_lock(&list->write_lock);
+
+    RcuNode * node = find_locked(list, compare, x, &link, &prev);
+    if (!node) {
+        pthread_mutex_unlock(&list->write_lock);
+        free(replacement);
+        return 1;
+    }
+
+    atomic_init(&replacement->next, atomic_load_explicit(&node->next, memory_order_relaxed));
+    atomic_store_explicit(link, replacement, memory_order_release);
+    if (list->last == node)
+        list->last = replacement;
+
+    pthread_mutex_unlock(&list->write_lock);
+
+    if (epoch_retire(list->domain, node, node_reclaim, list)) {
+        epoch_barrier(list->domain);
+        node_reclaim(node, list);
+    }
+    return 0;
+}
+
+void rcu_list_synchronize(RcuList * list) {
+    if (!list) {
+        fputs(NULL_RCU_LIST_POINTER, stderr);
+        return;
+    }
+    epoch_barrier(list->domain);
+}
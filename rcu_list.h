@@ -0,0 +1,167 @@
+#ifndef RCU_LIST_H
+#define RCU_LIST_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "epoch.h"
+
+/**
+ * @file rcu_list.h
+ * @brief Read-mostly concurrent linked list with lock-free readers.
+ *
+ * Readers walk the list without locks or read-modify-write operations, inside
+ * a read-side critical section delimited by rcu_read_lock and rcu_read_unlock.
+ * Writers are serialized by a mutex and publish every change with a single
+ * release store of a next pointer, so a reader always sees the list either
+ * before or after the change, never in between.
+ *
+ * Removed nodes keep their next pointer, so readers standing on them can go
+ * on walking. They are retired to an epoch domain, and the node and its data
+ * (through destroy) are released only after every reader that could have seen
+ * them has left its critical section.
+ *
+ * Each reading thread registers once with rcu_list_register and uses its own
+ * record for every critical section. Writers must not modify the list from
+ * inside a critical section of their own.
+ */
+
+/**
+ * @brief A node of the list
+ */
+typedef struct RcuNode {
+    void * data;                        /**< Pointer to the data stored in the node. */
+    _Atomic(struct RcuNode *) next;     /**< Next node, NULL at the end. */
+} RcuNode;
+
+/**
+ * @brief The concurrent list structure
+ */
+typedef struct RcuList {
+    _Atomic(RcuNode *) first;           /**< First node, NULL if the list is empty. */
+    RcuNode * last;                     /**< Last node, used by writers only. */
+    atomic_int num_elem;                /**< Number of elements in the list. */
+    void (*destroy)(void * data);       /**< Element destructor, called once no reader can see it. */
+    EpochDomain * domain;               /**< Reclamation domain of the removed nodes. */
+    pthread_mutex_t write_lock;         /**< Serializes writers. */
+} RcuList;
+
+/**
+ * @brief Initializes a new concurrent list
+ *
+ * @param destroy Function used to free removed elements, or NULL.
+ *
+ * @return A pointer to the new list, or NULL if memory allocation fails.
+ */
+RcuList * rcu_list_init(void (*destroy)(void * data));
+
+/**
+ * @brief Destroys the list and every element left
+ *
+ * No other thread may be using the list, and every reader must be unregistered.
+ *
+ * @param list Pointer to the list
+ */
+void rcu_list_terminate(RcuList * list);
+
+/**
+ * @brief Registers the calling thread as a reader
+ *
+ * @param list Pointer to the list
+ *
+ * @return The reader record of the thread, or NULL on error.
+ */
+EpochRecord * rcu_list_register(RcuList * list);
+
+/**
+ * @brief Unregisters a reader
+ *
+ * @param list Pointer to the list
+ *
+ * @param record Record returned by rcu_list_register
+ */
+void rcu_list_unregister(RcuList * list, EpochRecord * record);
+
+/**
+ * @brief Searches for an element, from a read-side critical section
+ *
+ * The element returned stays valid until rcu_read_unlock. See list_search for
+ * the compare function.
+ *
+ * @param list Pointer to the list
+ *
+ * @param compare Function comparing an element with x
+ *
+ * @param x Data searched for
+ *
+ * @return The first element equal to x, or NULL if there is none.
+ */
+void * rcu_list_search(RcuList * list, int (*compare)(void * a, void * b), void * x);
+
+/**
+ * @brief Inserts an element at the beginning of the list
+ *
+ * @return 0 on success, 1 otherwise.
+ */
+int rcu_list_insert_head(RcuList * list, void * data);
+
+/**
+ * @brief Appends an element at the end of the list
+ *
+ * @return 0 on success, 1 otherwise.
+ */
+int rcu_list_append(RcuList * list, void * data);
+
+/**
+ * @brief Removes the first element equal to x
+ *
+ * The node and its data are released once no reader can see them anymore.
+ *
+ * @return 0 if an element was removed, 1 otherwise.
+ */
+int rcu_list_remove(RcuList * list, int (*compare)(void * a, void * b), void * x);
+
+/**
+ * @brief Replaces the first element equal to x by data
+ *
+ * Readers see either the old or the new element, never both nor none. The old
+ * element is released once no reader can see it anymore.
+ *
+ * @return 0 if an element was replaced, 1 otherwise.
+ */
+int rcu_list_replace(RcuList * list, int (*compare)(void * a, void * b), void * x, void * data);
+
+/**
+ * @brief Waits until every element removed so far has been released
+ *
+ * It must not be called from inside a read-side critical section.
+ *
+ * @param list Pointer to the list
+ */
+void rcu_list_synchronize(RcuList * list);
+
+/**
+ * @brief Enters a read-side critical section
+ */
+#define rcu_read_lock(list, record) epoch_enter((list)->domain, (record))
+
+/**
+ * @brief Leaves a read-side critical section
+ */
+#define rcu_read_unlock(list, record) epoch_exit(record)
+
+/**
+ * @brief First node of the list, from a read-side critical section
+ */
+#define rcu_list_first(list) atomic_load_explicit(&(list)->first, memory_order_acquire)
+
+/**
+ * @brief Next node, from a read-side critical section
+ */
+#define rcu_node_next(node) atomic_load_explicit(&(node)->next, memory_order_acquire)
+
+/**
+ * @brief Number of elements in the list
+ */
+#define rcu_list_num_elem(list) atomic_load_explicit(&(list)->num_elem, memory_order_relaxed)
+
+#endif
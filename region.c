@@ -0,0 +1,168 @@
+#include "region.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define REGION_ALLOCATION_ERROR "Memory allocation error for the region\n"
+
+#define REGION_NULL_POINTER "Region pointer parameter is NULL\n"
+
+#define REGION_DEFAULT_CHUNK_SIZE (64 * 1024)
+
+#define REGION_ALIGN _Alignof(max_align_t)
+
+#define REGION_ROUND(size) (((size) + REGION_ALIGN - 1) / REGION_ALIGN * REGION_ALIGN)
+
+/* Chunk memory starts right after the header, aligned for any type */
+#define REGION_CHUNK_DATA(chunk) ((char *) (chunk) + REGION_ROUND(sizeof(RegionChunk)))
+
+static RegionChunk * chunk_alloc(size_t size) {
+    RegionChunk * chunk = malloc(REGION_ROUND(sizeof(RegionChunk)) + size);
+    if (!chunk) {
+        fputs(REGION_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+static void * allocator_region_alloc(size_t size, void * ctx) {
+    return region_alloc(ctx, size);
+}
+
+/* Grows the last allocation in place when it fits, copies it otherwise. The
+ * old size isn't known, so the copy takes what's left of its chunk, up to the
+ * new size: never less than the old allocation, never past the chunk. */
+static void * allocator_region_realloc(void * ptr, size_t size, void * ctx) {
+    Region * region = ctx;
+
+    if (!ptr)
+        return region_alloc(region, size);
+
+    RegionChunk * chunk = region->chunks;
+    while (chunk && !((char *) ptr >= REGION_CHUNK_DATA(chunk)
+                      && (char *) ptr < REGION_CHUNK_DATA(chunk) + chunk->size))
+        chunk = chunk->next;
+
+    if (!chunk)
+        return NULL;
+
+    size_t offset = (char *) ptr - REGION_CHUNK_DATA(chunk);
+
+    if (ptr == region->last && chunk == region->chunks && offset + size <= chunk->size) {
+        region->bytes = region->bytes - chunk->used + offset + REGION_ROUND(size);
+        chunk->used = offset + REGION_ROUND(size);
+        return ptr;
+    }
+
+    void * moved = region_alloc(region, size);
+    if (!moved)
+        return NULL;
+
+    size_t available = chunk->size - offset;
+    memcpy(moved, ptr, available < size ? available : size);
+    return moved;
+}
+
+Region * region_init(size_t chunk_size) {
+    Region * region = malloc(sizeof(Region));
+    if (!region) {
+        fputs(REGION_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    region->chunk_size = REGION_ROUND(chunk_size > 0 ? chunk_size : REGION_DEFAULT_CHUNK_SIZE);
+    region->chunks = chunk_alloc(region->chunk_size);
+    if (!region->chunks) {
+        free(region);
+        return NULL;
+    }
+    region->chunks->next = NULL;
+
+    region->allocator.alloc = allocator_region_alloc;
+    region->allocator.realloc = allocator_region_realloc;
+    region->allocator.free = NULL;
+    region->allocator.ctx = region;
+    region->last = NULL;
+    region->bytes = 0;
+
+    return region;
+}
+
+void region_terminate(Region * region) {
+    if (!region) {
+        fputs(REGION_NULL_POINTER, stderr);
+        return;
+    }
+
+    while (region->chunks) {
+        RegionChunk * next = region->chunks->next;
+        free(region->chunks);
+        region->chunks = next;
+    }
+    free(region);
+}
+
+void region_reset(Region * region) {
+    if (!region) {
+        fputs(REGION_NULL_POINTER, stderr);
+        return;
+    }
+
+    RegionChunk * chunk = region->chunks->next;
+    while (chunk) {
+        RegionChunk * next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    region->chunks->next = NULL;
+    region->chunks->used = 0;
+    region->last = NULL;
+    region->bytes = 0;
+}
+
+void * region_alloc(Region * region, size_t size) {
+    if (!region) {
+        fputs(REGION_NULL_POINTER, stderr);
+        return NULL;
+    }
+
+    size = REGION_ROUND(size > 0 ? size : 1);
+    RegionChunk * current = region->chunks;
+
+    if (size <= current->size - current->used) {
+        void * ptr = REGION_CHUNK_DATA(current) + current->used;
+        current->used += size;
+        region->bytes += size;
+        region->last = ptr;
+        return ptr;
+    }
+
+    /* Large allocations get their own chunk, behind the current one so it
+     * keeps serving the small ones */
+    if (size > region->chunk_size / 4) {
+        RegionChunk * chunk = chunk_alloc(size);
+        if (!chunk)
+            return NULL;
+
+        chunk->used = size;
+        chunk->next = current->next;
+        current->next = chunk;
+        region->bytes += size;
+        return REGION_CHUNK_DATA(chunk);
+    }
+
+    RegionChunk * chunk = chunk_alloc(region->chunk_size);
+    if (!chunk)
+        return NULL;
+
+    chunk->next = current;
+    chunk->used = size;
+    region->chunks = chunk;
+    region->bytes += size;
+    region->last = REGION_CHUNK_DATA(chunk);
+    return region->last;
+}
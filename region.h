@@ -0,0 +1,90 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include <stddef.h>
+#include "allocator.h"
+
+/**
+ * @file region.h
+ * @brief Region (arena) allocator with bulk release.
+ *
+ * A region hands out memory by bumping a pointer inside large chunks, and
+ * gives it all back at once when it is reset or terminated. There is no way
+ * to free a single allocation.
+ *
+ * Containers bound to a region through its allocator, and whose elements are
+ * allocated from the same region, are torn down without walking their nodes
+ * or calling a destructor per element: terminating the container only
+ * releases what lives outside the region, and region_terminate frees the
+ * rest with one free per chunk.
+ *
+ * A region is not thread safe.
+ */
+
+/**
+ * @brief A chunk of region memory
+ */
+typedef struct RegionChunk {
+    struct RegionChunk * next;          /**< Chunk allocated before this one. */
+    size_t size;                        /**< Usable bytes after the chunk header. */
+    size_t used;                        /**< Bytes handed out so far. */
+} RegionChunk;
+
+/**
+ * @brief The region structure
+ */
+typedef struct Region {
+    Allocator allocator;                /**< Allocator view of the region, for containers. */
+    RegionChunk * chunks;               /**< Current chunk, followed by the older ones. */
+    size_t chunk_size;                  /**< Usable bytes of a regular chunk. */
+    void * last;                        /**< Last allocation, the only one realloc can grow in place. */
+    size_t bytes;                       /**< Bytes handed out since the last reset. */
+} Region;
+
+/**
+ * @brief Initializes a new region
+ *
+ * @param chunk_size Usable bytes of each chunk. Allocations larger than a
+ *                   quarter of it get a chunk of their own. 0 uses 64 KiB.
+ *
+ * @return A pointer to the new region, or NULL on error.
+ */
+Region * region_init(size_t chunk_size);
+
+/**
+ * @brief Frees the region and everything allocated from it
+ */
+void region_terminate(Region * region);
+
+/**
+ * @brief Frees everything allocated from the region, keeping it usable
+ *
+ * The current chunk is kept for the next allocations, the others are freed.
+ * Containers bound to the region must be terminated first.
+ */
+void region_reset(Region * region);
+
+/**
+ * @brief Allocates memory from the region
+ *
+ * The memory is aligned for any type and lives until the region is reset or
+ * terminated.
+ *
+ * @return A pointer to the memory, or NULL on error.
+ */
+void * region_alloc(Region * region, size_t size);
+
+/**
+ * @brief Allocator view of the region, to bind containers to it
+ *
+ * Its free function is NULL, which tells the containers that their memory is
+ * released in bulk. See allocator_frees_in_bulk.
+ */
+#define region_allocator(region) ((const Allocator *) &(region)->allocator)
+
+/**
+ * @brief Bytes handed out since the region was created or last reset
+ */
+#define region_bytes(region) ((region)->bytes)
+
+#endif
@@ -0,0 +1,302 @@
+#define _DEFAULT_SOURCE
+#include "scheduler.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define SCHEDULER_ALLOCATION_ERROR "Memory allocation error for the scheduler"
+
+#define SCHEDULER_THREAD_ERROR "Could not start a scheduler worker thread"
+
+#define SCHEDULER_NULL_POINTER "Scheduler pointer parameter is NULL"
+
+#define TASK_ALLOCATION_ERROR "Memory allocation error for a task"
+
+#define NULL_TASK_FUNCTION "Task function or group pointer is NULL"
+
+/* Failed searches for work before a worker parks */
+#define SCHEDULER_SPIN_ROUNDS 64
+
+/* Attempts to steal from a deque that keeps losing races */
+#define SCHEDULER_STEAL_RETRIES 4
+
+#define SCHEDULER_DEQUE_CAPACITY 256
+
+typedef struct Task {
+    void (*fn)(void * arg);
+    void * arg;
+    TaskGroup * group;
+} Task;
+
+/* Worker running on the calling thread, NULL outside any pool */
+static _Thread_local Worker * current_worker;
+
+static uint64_t next_random(uint64_t * state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static Task * pop_injected(Scheduler * sched) {
+    Task * task = NULL;
+
+    pthread_mutex_lock(&sched->lock);
+    if (list_num_elem(sched->injection) > 0) {
+        task = list_head(sched->injection)->next->data;
+        dequeue(sched->injection);
+        atomic_fetch_sub_explicit(&sched->num_injected, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&sched->lock);
+
+    return task;
+}
+
+/* Looks for a task: own deque first, then the injection queue, then the
+ * other deques starting at a random victim */
+static Task * find_task(Scheduler * sched, Worker * self) {
+    void * task;
+
+    if (self && ws_deque_take(self->deque, &task) == WS_DEQUE_OK)
+        return task;
+
+    if (atomic_load_explicit(&sched->num_injected, memory_order_relaxed) > 0
+        && (task = pop_injected(sched)))
+        return task;
+
+    uint64_t seed = (uint64_t) (uintptr_t) &task;
+    uint64_t * rng = self ? &self->rng : &seed;
+    int start = (int) (next_random(rng) % sched->num_workers);
+
+    for (int i = 0; i < sched->num_workers; i++) {
+        Worker * victim = &sched->workers[(start + i) % sched->num_workers];
+        if (victim == self)
+            continue;
+
+        for (int retry = 0; retry < SCHEDULER_STEAL_RETRIES; retry++) {
+            int result = ws_deque_steal(victim->deque, &task);
+            if (result == WS_DEQUE_OK)
+                return task;
+            if (result == WS_DEQUE_EMPTY)
+                break;
+        }
+    }
+    return NULL;
+}
+
+static void run_task(Task * task) {
+    TaskGroup * group = task->group;
+
+    task->fn(task->arg);
+    free(task);
+    atomic_fetch_sub_explicit(&group->pending, 1, memory_order_release);
+}
+
+/* Sleeps until a spawn happens after the signals value seen. The sleepers
+ * increment comes before the signals check, and spawns bump signals before
+ * checking sleepers, so either side always sees the other. */
+static void park(Scheduler * sched, unsigned seen) {
+    pthread_mutex_lock(&sched->lock);
+    atomic_fetch_add(&sched->sleepers, 1);
+    while (atomic_load(&sched->signals) == seen && !atomic_load(&sched->stop))
+        pthread_cond_wait(&sched->wake, &sched->lock);
+    atomic_fetch_sub(&sched->sleepers, 1);
+    pthread_mutex_unlock(&sched->lock);
+}
+
+static void * worker_main(void * arg) {
+    Worker * self = arg;
+    Scheduler * sched = self->sched;
+    int idle = 0;
+
+    current_worker = self;
+
+    while (!atomic_load_explicit(&sched->stop, memory_order_relaxed)) {
+        unsigned seen = atomic_load(&sched->signals);
+        Task * task = find_task(sched, self);
+
+        if (task) {
+            run_task(task);
+            idle = 0;
+        } else if (++idle < SCHEDULER_SPIN_ROUNDS) {
+            sched_yield();
+        } else {
+            park(sched, seen);
+            idle = 0;
+        }
+    }
+    return NULL;
+}
+
+/* Stops and joins the first started workers, which may be stealing from any
+ * deque, and only then destroys the deques and the scheduler */
+static void scheduler_shutdown(Scheduler * sched, int started) {
+    pthread_mutex_lock(&sched->lock);
+    atomic_store(&sched->stop, 1);
+    pthread_cond_broadcast(&sched->wake);
+    pthread_mutex_unlock(&sched->lock);
+
+    for (int i = 0; i < started; i++)
+        pthread_join(sched->workers[i].thread, NULL);
+
+    for (int i = 0; i < sched->num_workers; i++) {
+        void * task;
+        if (!sched->workers[i].deque)
+            continue;
+        while (ws_deque_take(sched->workers[i].deque, &task) == WS_DEQUE_OK)
+            free(task);
+        ws_deque_terminate(sched->workers[i].deque);
+    }
+
+    while (list_num_elem(sched->injection) > 0) {
+        free(list_head(sched->injection)->next->data);
+        dequeue(sched->injection);
+    }
+    queue_terminate(sched->injection);
+
+    pthread_mutex_destroy(&sched->lock);
+    pthread_cond_destroy(&sched->wake);
+    free(sched->workers);
+    free(sched);
+}
+
+Scheduler * scheduler_init(int num_threads) {
+    if (num_threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = online > 0 ? (int) online : 1;
+    }
+
+    Scheduler * sched = malloc(sizeof(Scheduler));
+    if (!sched) {
+        fputs(SCHEDULER_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    sched->workers = calloc(num_threads, sizeof(Worker));
+    if (!sched->workers) {
+        fputs(SCHEDULER_ALLOCATION_ERROR, stderr);
+        free(sched);
+        return NULL;
+    }
+
+    sched->num_workers = num_threads;
+    sched->injection = queue_init(NULL);
+    if (!sched->injection) {
+        free(sched->workers);
+        free(sched);
+        return NULL;
+    }
+
+    pthread_mutex_init(&sched->lock, NULL);
+    pthread_cond_init(&sched->wake, NULL);
+    atomic_init(&sched->sleepers, 0);
+    atomic_init(&sched->signals, 0);
+    atomic_init(&sched->num_injected, 0);
+    atomic_init(&sched->stop, 0);
+
+    /* Every deque exists before any worker starts, since workers steal from
+     * all of them */
+    int failed = 0;
+    for (int i = 0; i < num_threads; i++) {
+        Worker * worker = &sched->workers[i];
+        worker->sched = sched;
+        worker->rng = 0x9E3779B97F4A7C15ULL * (i + 1);
+        worker->deque = ws_deque_init(SCHEDULER_DEQUE_CAPACITY);
+        failed |= !worker->deque;
+    }
+
+    for (int i = 0; i < num_threads && !failed; i++) {
+        if (pthread_create(&sched->workers[i].thread, NULL, worker_main, &sched->workers[i]) != 0) {
+            fputs(SCHEDULER_THREAD_ERROR, stderr);
+            scheduler_shutdown(sched, i);
+            return NULL;
+        }
+    }
+
+    if (failed) {
+        scheduler_shutdown(sched, 0);
+        return NULL;
+    }
+
+    return sched;
+}
+
+void scheduler_terminate(Scheduler * sched) {
+    if (!sched) {
+        fputs(SCHEDULER_NULL_POINTER, stderr);
+        return;
+    }
+
+    scheduler_shutdown(sched, sched->num_workers);
+}
+
+void task_group_init(TaskGroup * group) {
+    atomic_init(&group->pending, 0);
+}
+
+int scheduler_spawn(Scheduler * sched, TaskGroup * group, void (*fn)(void * arg), void * arg) {
+    if (!sched) {
+        fputs(SCHEDULER_NULL_POINTER, stderr);
+        return 1;
+    } else if (!fn || !group) {
+        fputs(NULL_TASK_FUNCTION, stderr);
+        return 1;
+    }
+
+    Task * task = malloc(sizeof(Task));
+    if (!task) {
+        fputs(TASK_ALLOCATION_ERROR, stderr);
+        return 1;
+    }
+
+    task->fn = fn;
+    task->arg = arg;
+    task->group = group;
+    atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+
+    Worker * self = current_worker;
+    int failed;
+
+    if (self && self->sched == sched) {
+        failed = ws_deque_push(self->deque, task);
+    } else {
+        pthread_mutex_lock(&sched->lock);
+        failed = enqueue(sched->injection, task);
+        if (!failed)
+            atomic_fetch_add_explicit(&sched->num_injected, 1, memory_order_relaxed);
+        pthread_mutex_unlock(&sched->lock);
+    }
+
+    if (failed) {
+        atomic_fetch_sub_explicit(&group->pending, 1, memory_order_relaxed);
+        free(task);
+        return 1;
+    }
+
+    atomic_fetch_add(&sched->signals, 1);
+    if (atomic_load(&sched->sleepers) > 0) {
+        pthread_mutex_lock(&sched->lock);
+        pthread_cond_signal(&sched->wake);
+        pthread_mutex_unlock(&sched->lock);
+    }
+    return 0;
+}
+
+void scheduler_wait(Scheduler * sched, TaskGroup * group) {
+    if (!sched) {
+        fputs(SCHEDULER_NULL_POINTER, stderr);
+        return;
+    }
+
+    Worker * self = current_worker && current_worker->sched == sched ? current_worker : NULL;
+
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) > 0) {
+        Task * task = find_task(sched, self);
+        if (task)
+            run_task(task);
+        else
+            sched_yield();
+    }
+}
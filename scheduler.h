@@ -0,0 +1,118 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "queue.h"
+#include "ws_deque.h"
+
+/**
+ * @file scheduler.h
+ * @brief Work-stealing task scheduler for fork/join parallelism.
+ *
+ * Each worker thread owns a WsDeque. Tasks spawned by a worker are pushed to
+ * its own deque and run by it in LIFO order, while idle workers steal from the
+ * top of randomly chosen deques. Tasks spawned from threads outside the pool
+ * go through a shared injection Queue guarded by a mutex.
+ *
+ * Workers that find nothing to do spin for a short while and then park on a
+ * condition variable, and are woken up when new tasks are spawned.
+ *
+ * Tasks are grouped in TaskGroups. Waiting on a group doesn't block the
+ * calling thread: it runs pending tasks, its own or stolen ones, until every
+ * task of the group has finished. That makes nested fork/join safe.
+ */
+
+/**
+ * @brief A group of tasks that can be waited on together
+ */
+typedef struct TaskGroup {
+    atomic_int pending;             /**< Number of spawned tasks not finished yet. */
+} TaskGroup;
+
+struct Scheduler;
+
+/**
+ * @brief A worker thread
+ */
+typedef struct Worker {
+    struct Scheduler * sched;       /**< Scheduler owning the worker. */
+    WsDeque * deque;                /**< Deque of tasks spawned by the worker. */
+    uint64_t rng;                   /**< State of the victim selection generator. */
+    pthread_t thread;               /**< The worker thread. */
+} Worker;
+
+/**
+ * @brief The scheduler structure
+ */
+typedef struct Scheduler {
+    int num_workers;                /**< Number of worker threads. */
+    Worker * workers;               /**< The workers. */
+    Queue * injection;              /**< Tasks spawned from outside the pool. */
+    atomic_int num_injected;        /**< Length of injection, readable without the lock. */
+    pthread_mutex_t lock;           /**< Guards injection and parking. */
+    pthread_cond_t wake;            /**< Signaled when tasks are spawned. */
+    atomic_int sleepers;            /**< Number of parked workers. */
+    atomic_uint signals;            /**< Bumped on every spawn, to avoid lost wakeups. */
+    atomic_int stop;                /**< Set when the scheduler is terminated. */
+} Scheduler;
+
+/**
+ * @brief Initializes a scheduler and starts its workers
+ *
+ * @param num_threads Number of worker threads. Non positive values use one
+ *                    thread per online processor.
+ *
+ * @return A pointer to the new scheduler, or NULL if it can't be created.
+ */
+Scheduler * scheduler_init(int num_threads);
+
+/**
+ * @brief Stops the workers and destroys the scheduler
+ *
+ * Every task group must have been waited on before, since tasks still queued
+ * are dropped without running.
+ *
+ * @param sched Pointer to the scheduler
+ */
+void scheduler_terminate(Scheduler * sched);
+
+/**
+ * @brief Initializes an empty task group
+ *
+ * @param group Pointer to the group
+ */
+void task_group_init(TaskGroup * group);
+
+/**
+ * @brief Spawns a task
+ *
+ * @param sched Pointer to the scheduler
+ *
+ * @param group Group the task belongs to
+ *
+ * @param fn Function run by the task
+ *
+ * @param arg Argument given to fn
+ *
+ * @return 0 if the task was spawned, 1 otherwise.
+ */
+int scheduler_spawn(Scheduler * sched, TaskGroup * group, void (*fn)(void * arg), void * arg);
+
+/**
+ * @brief Waits for every task of a group, running pending tasks meanwhile
+ *
+ * It can be called both from inside a task and from outside the pool.
+ *
+ * @param sched Pointer to the scheduler
+ *
+ * @param group Group to be waited on
+ */
+void scheduler_wait(Scheduler * sched, TaskGroup * group);
+
+/**
+ * @brief Number of worker threads of a scheduler
+ */
+#define scheduler_num_workers(sched) ((sched)->num_workers)
+
+#endif
@@ -1,8 +1,8 @@
 #include <stdlib.h>
 #include "stack.h"
 
-void push(Stack * stack, void * x) {
-    list_insert_next(stack, list_head(stack), x);
+int push(Stack * stack, void * x) {
+    return list_insert_next(stack, list_head(stack), x);
 }
 
 void pop(Stack * stack) {
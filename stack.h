@@ -23,6 +23,7 @@ typedef ListNode StackNode;
 typedef List Stack;
 
 #define stack_init list_init
+#define stack_init_with list_init_with
 #define stack_terminate list_terminate
 
 /**
@@ -44,8 +45,10 @@ typedef List Stack;
  * 
  * @param stack a pointer to the stack
  * @param x data to be pushed
+ * 
+ * @return 0 if the element was pushed, 1 otherwise
  */
-void push(Stack * stack, void * x);
+int push(Stack * stack, void * x);
 
 /**
  * @brief Pops a element from the stack
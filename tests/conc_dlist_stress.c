@@ -0,0 +1,203 @@
+/*
+ * Multithreaded stress test of the concurrent sorted list.
+ *
+ * Every thread owns the keys congruent to its index modulo the number of
+ * threads and inserts and removes them at random, keeping a private record of
+ * which ones it left in the list. Meanwhile it looks up keys of the other
+ * threads and walks the whole list. At the end the list must hold exactly the
+ * keys the threads think they left, in order, and every removed element must
+ * have been destroyed once.
+ *
+ * Build and run from the repository root:
+ *
+ *      gcc -std=c11 -O2 -pthread -I. tests/conc_dlist_stress.c conc_dlist.c epoch.c -o conc_dlist_stress
+ *      ./conc_dlist_stress [threads] [operations per thread]
+ *
+ * Adding -fsanitize=thread or -fsanitize=address is worthwhile.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "conc_dlist.h"
+
+#define KEYS_PER_THREAD 512
+
+static ConcDlist * list;
+static int num_threads;
+static int num_ops;
+static atomic_long live_elems;
+static atomic_int failures;
+
+static int compare(void * a, void * b) {
+    int x = *(int *) a, y = *(int *) b;
+    return (x > y) - (x < y);
+}
+
+static void destroy(void * data) {
+    atomic_fetch_sub(&live_elems, 1);
+    free(data);
+}
+
+static uint64_t next_random(uint64_t * state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+typedef struct WalkCheck {
+    int last;
+    int sorted;
+} WalkCheck;
+
+static void check_order(void * data, void * ctx) {
+    WalkCheck * check = ctx;
+    int key = *(int *) data;
+
+    if (key <= check->last)
+        check->sorted = 0;
+    check->last = key;
+}
+
+typedef struct Worker {
+    int index;
+    char present[KEYS_PER_THREAD];
+} Worker;
+
+static void * run(void * arg) {
+    Worker * w = arg;
+    EpochRecord * record = conc_dlist_register(list);
+    uint64_t rng = 0x9e3779b97f4a7c15ULL * (w->index + 1);
+
+    if (!record) {
+        atomic_fetch_add(&failures, 1);
+        return NULL;
+    }
+
+    for (int op = 0; op < num_ops; op++) {
+        uint64_t r = next_random(&rng);
+        int slot = (int) (r % KEYS_PER_THREAD);
+        int key = slot * num_threads + w->index;
+
+        switch ((r >> 32) % 8) {
+        case 0: case 1: case 2: {
+            int * data = malloc(sizeof(int));
+            *data = key;
+            atomic_fetch_add(&live_elems, 1);
+            int inserted = conc_dlist_insert(list, record, data) == 0;
+            if (inserted == w->present[slot]) {
+                fprintf(stderr, "insert of %d returned %d with the key %s\n", key, inserted,
+                        w->present[slot] ? "present" : "absent");
+                atomic_fetch_add(&failures, 1);
+            }
+            if (!inserted)
+                destroy(data);
+            w->present[slot] = 1;
+            break;
+        }
+        case 3: case 4: case 5: {
+            int removed = conc_dlist_remove(list, record, &key) == 0;
+            if (removed != w->present[slot]) {
+                fprintf(stderr, "remove of %d returned %d\n", key, removed);
+                atomic_fetch_add(&failures, 1);
+            }
+            w->present[slot] = 0;
+            break;
+        }
+        case 6: {
+            /* Keys owned by this thread have a known answer */
+            if (conc_dlist_contains(list, record, &key) != w->present[slot]) {
+                fprintf(stderr, "contains of %d is wrong\n", key);
+                atomic_fetch_add(&failures, 1);
+            }
+            int other = key + 1;
+            conc_dlist_contains(list, record, &other);
+            break;
+        }
+        default:
+            if (op % 64 == 7) {
+                WalkCheck check = { -1, 1 };
+                conc_dlist_for_each(list, record, check_order, &check);
+                if (!check.sorted) {
+                    fputs("walk saw elements out of order\n", stderr);
+                    atomic_fetch_add(&failures, 1);
+                }
+            }
+            break;
+        }
+    }
+
+    conc_dlist_unregister(list, record);
+    return NULL;
+}
+
+typedef struct FinalCheck {
+    Worker * workers;
+    int last;
+    long count;
+    int bad;
+} FinalCheck;
+
+static void check_final(void * data, void * ctx) {
+    FinalCheck * check = ctx;
+    int key = *(int *) data;
+
+    if (key <= check->last || !check->workers[key % num_threads].present[key / num_threads])
+        check->bad = 1;
+    check->last = key;
+    check->count++;
+}
+
+int main(int argc, char ** argv) {
+    num_threads = argc > 1 ? atoi(argv[1]) : 8;
+    num_ops = argc > 2 ? atoi(argv[2]) : 200000;
+    if (num_threads <= 0 || num_ops <= 0) {
+        fputs("usage: conc_dlist_stress [threads] [operations per thread]\n", stderr);
+        return 2;
+    }
+
+    list = conc_dlist_init(compare, destroy);
+    Worker * workers = calloc(num_threads, sizeof(Worker));
+    pthread_t * threads = malloc(num_threads * sizeof(pthread_t));
+    if (!list || !workers || !threads)
+        return 1;
+
+    for (int i = 0; i < num_threads; i++) {
+        workers[i].index = i;
+        pthread_create(&threads[i], NULL, run, &workers[i]);
+    }
+    for (int i = 0; i < num_threads; i++)
+        pthread_join(threads[i], NULL);
+
+    long expected = 0;
+    for (int i = 0; i < num_threads; i++)
+        for (int s = 0; s < KEYS_PER_THREAD; s++)
+            expected += workers[i].present[s];
+
+    EpochRecord * record = conc_dlist_register(list);
+    FinalCheck check = { workers, -1, 0, 0 };
+    conc_dlist_for_each(list, record, check_final, &check);
+    conc_dlist_unregister(list, record);
+
+    if (check.bad || check.count != expected || conc_dlist_num_elem(list) != expected) {
+        fprintf(stderr, "final list holds %ld elements (counter %d), expected %ld%s\n", check.count,
+                conc_dlist_num_elem(list), expected, check.bad ? ", some misplaced or unexpected" : "");
+        atomic_fetch_add(&failures, 1);
+    }
+
+    conc_dlist_terminate(list);
+    if (atomic_load(&live_elems) != 0) {
+        fprintf(stderr, "%ld elements never destroyed\n", atomic_load(&live_elems));
+        atomic_fetch_add(&failures, 1);
+    }
+
+    int failed = atomic_load(&failures);
+    printf("%s: %d threads, %d operations each, %ld elements left\n",
+           failed ? "FAILED" : "passed", num_threads, num_ops, expected);
+
+    free(workers);
+    free(threads);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,213 @@
+#include "timer_wheel.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+#define TIMER_WHEEL_ALLOCATION_ERROR "Error in memory allocation for timer wheel\n"
+
+#define NULL_TIMER_WHEEL_POINTER "Timer wheel pointer is null\n"
+
+#define NULL_TIMER_POINTER "Timer pointer is null\n"
+
+#define NULL_CALLBACK_POINTER "Timer callback is null\n"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+/* Largest distance, in ticks, the top level can represent */
+#define MAX_DELTA (((uint64_t) 1 << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+TimerWheel * timer_wheel_init(uint64_t now) {
+    TimerWheel * wheel = calloc(1, sizeof(TimerWheel));
+    if (!wheel) {
+        fputs(TIMER_WHEEL_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    wheel->now = now;
+
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            wheel->slots[level][slot] = dlist_init(NULL);
+            if (!wheel->slots[level][slot]) {
+                timer_wheel_terminate(wheel);
+                return NULL;
+            }
+        }
+    }
+
+    return wheel;
+}
+
+void timer_wheel_terminate(TimerWheel * wheel) {
+    if (!wheel) {
+        fputs(NULL_TIMER_WHEEL_POINTER, stderr);
+        return;
+    }
+
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            Dlist * list = wheel->slots[level][slot];
+            if (!list)
+                continue;       /* left by a failed timer_wheel_init */
+
+            DlistNode * head = dlist_head(list);
+
+            for (DlistNode * walker = head->next; walker != head; walker = walker->next)
+                ((Timer *) walker->data)->slot = NULL;
+
+            dlist_terminate(list);
+        }
+    }
+    free(wheel);
+}
+
+/*
+ * Puts a timer in the slot matching its distance to now. The expiration must
+ * not be before now: a timer expiring exactly now goes to the current level 0
+ * slot, which timer_wheel_tick fires right after cascading. Returns 1 if the
+ * node can't be allocated, leaving the timer untouched.
+ */
+static int place(TimerWheel * wheel, Timer * timer) {
+    uint64_t delta = timer->expires - wheel->now;
+    uint64_t at = timer->expires;
+    int level = 0;
+
+    if (delta > MAX_DELTA)
+        at = wheel->now + MAX_DELTA;    /* cascades again until it fits */
+
+    while (level < TIMER_WHEEL_LEVELS - 1
+           && (at - wheel->now) >> (TIMER_WHEEL_SLOT_BITS * (level + 1)) != 0)
+        level++;
+
+    Dlist * slot = wheel->slots[level][(at >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK];
+
+    if (dlist_insert_prev(slot, dlist_head(slot), timer))
+        return 1;
+
+    timer->slot = slot;
+    timer->node = dlist_head(slot)->prev;
+    return 0;
+}
+
+void timer_init(Timer * timer) {
+    if (!timer) {
+        fputs(NULL_TIMER_POINTER, stderr);
+        return;
+    }
+
+    timer->expires = 0;
+    timer->callback = NULL;
+    timer->arg = NULL;
+    timer->slot = NULL;
+    timer->node = NULL;
+}
+
+/* Unlinks a pending timer from its slot */
+static void unlink_timer(Timer * timer) {
+    delist_remove_next(timer->slot, timer->node->prev);
+    timer->slot = NULL;
+    timer->node = NULL;
+}
+
+int timer_wheel_add(TimerWheel * wheel, Timer * timer, uint64_t expires,
+                    void (*callback)(Timer * timer, void * arg), void * arg) {
+    if (!wheel) {
+        fputs(NULL_TIMER_WHEEL_POINTER, stderr);
+        return 1;
+    } else if (!timer) {
+        fputs(NULL_TIMER_POINTER, stderr);
+        return 1;
+    } else if (!callback) {
+        fputs(NULL_CALLBACK_POINTER, stderr);
+        return 1;
+    }
+
+    /* The timer is placed before leaving its old slot, so a failure leaves
+     * it as it was */
+    Timer old = *timer;
+
+    timer->expires = expires > wheel->now ? expires : wheel->now + 1;
+    timer->callback = callback;
+    timer->arg = arg;
+
+    if (place(wheel, timer)) {
+        *timer = old;
+        return 1;
+    }
+
+    if (old.slot)
+        delist_remove_next(old.slot, old.node->prev);
+    else
+        wheel->num_timers++;
+    return 0;
+}
+
+int timer_wheel_cancel(TimerWheel * wheel, Timer * timer) {
+    if (!wheel) {
+        fputs(NULL_TIMER_WHEEL_POINTER, stderr);
+        return 1;
+    } else if (!timer) {
+        fputs(NULL_TIMER_POINTER, stderr);
+        return 1;
+    } else if (!timer_pending(timer)) {
+        return 1;
+    }
+
+    unlink_timer(timer);
+    wheel->num_timers--;
+    return 0;
+}
+
+/* Moves every timer of a slot to the level below */
+static void cascade(TimerWheel * wheel, int level, int index) {
+    Dlist * slot = wheel->slots[level][index];
+
+    while (dlist_num_elem(slot) > 0) {
+        DlistNode * node = dlist_head(slot)->next;
+        Timer * timer = node->data;
+
+        /* Out of memory: the rest stay where they are and fire late, rather
+         * than being lost */
+        if (place(wheel, timer))
+            break;
+
+        delist_remove_next(slot, node->prev);
+    }
+}
+
+int timer_wheel_tick(TimerWheel * wheel, uint64_t now) {
+    if (!wheel) {
+        fputs(NULL_TIMER_WHEEL_POINTER, stderr);
+        return 0;
+    }
+
+    int fired = 0;
+
+    while (wheel->now < now) {
+        /* Nothing can fire until a timer is added, so skip the idle ticks */
+        if (wheel->num_timers == 0) {
+            wheel->now = now;
+            break;
+        }
+
+        wheel->now++;
+
+        /* Each level whose lower levels wrapped around hands its current slot down */
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if ((wheel->now >> (TIMER_WHEEL_SLOT_BITS * (level - 1))) & SLOT_MASK)
+                break;
+            cascade(wheel, level, (wheel->now >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK);
+        }
+
+        Dlist * slot = wheel->slots[0][wheel->now & SLOT_MASK];
+
+        while (dlist_num_elem(slot) > 0) {
+            Timer * timer = dlist_head(slot)->next->data;
+            unlink_timer(timer);
+            wheel->num_timers--;
+            fired++;
+            timer->callback(timer, timer->arg);
+        }
+    }
+
+    return fired;
+}
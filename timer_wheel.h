@@ -0,0 +1,149 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include "dlist.h"
+
+/**
+ * @file timer_wheel.h
+ * @brief Hierarchical timing wheel built on circular doubly linked lists.
+ *
+ * Time is measured in ticks, whose length is up to the user. The wheel has
+ * TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots each, and every slot is
+ * a Dlist of pending timers. Level 0 slots hold timers expiring within the next
+ * TIMER_WHEEL_SLOTS ticks, one slot per tick. Each higher level covers a range
+ * TIMER_WHEEL_SLOTS times longer, and its timers cascade down to the lower
+ * levels as their expiration time gets closer.
+ *
+ * Adding and cancelling a timer are O(1). Timers are owned by the user, usually
+ * embedded in a larger structure, and each pending one keeps a handle to its
+ * slot node so cancelling doesn't need a search.
+ *
+ * A timer must be initialized with timer_init, or with TIMER_INIT, before it
+ * is added for the first time:
+ *
+ *      Timer t;
+ *      timer_init(&t);
+ *      timer_wheel_add(wheel, &t, wheel->now + 10, on_timeout, ctx);
+ *
+ * or, for a timer defined with an initializer,
+ *
+ *      Timer t = TIMER_INIT;
+ */
+
+#define TIMER_WHEEL_SLOT_BITS 8
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_LEVELS 4
+
+/**
+ * @brief A timer.
+ *
+ * Its fields are managed by the wheel and should only be read.
+ */
+typedef struct Timer {
+    uint64_t expires;                                 /**< Tick at which the timer fires. */
+    void (*callback)(struct Timer * timer, void * arg); /**< Function called when the timer fires. */
+    void * arg;                                       /**< User argument given to the callback. */
+    Dlist * slot;                                     /**< Slot holding the timer, NULL if not pending. */
+    DlistNode * node;                                 /**< Node of the timer inside its slot. */
+} Timer;
+
+/**
+ * @brief Initializer for a timer that is not pending.
+ */
+#define TIMER_INIT { 0, NULL, NULL, NULL, NULL }
+
+/**
+ * @brief The timing wheel.
+ */
+typedef struct TimerWheel {
+    uint64_t now;                                     /**< Last tick processed. */
+    int num_timers;                                   /**< Number of pending timers. */
+    Dlist * slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+} TimerWheel;
+
+/**
+ * @brief Initializes a new timing wheel.
+ *
+ * @param now The current tick.
+ *
+ * @return A pointer to the new wheel, or NULL if memory allocation fails.
+ */
+TimerWheel * timer_wheel_init(uint64_t now);
+
+/**
+ * @brief Destroys the wheel.
+ *
+ * Pending timers are dropped without firing and left as not pending.
+ *
+ * @param wheel Pointer to the wheel.
+ */
+void timer_wheel_terminate(TimerWheel * wheel);
+
+/**
+ * @brief Initializes a timer as not pending.
+ *
+ * Must be called before the first timer_wheel_add of the timer, which reads
+ * its fields to know whether it is already pending. It must not be called on
+ * a pending timer.
+ *
+ * @param timer Pointer to the timer.
+ */
+void timer_init(Timer * timer);
+
+/**
+ * @brief Schedules a timer.
+ *
+ * If the timer is already pending it is rescheduled. A timer whose expiration
+ * tick has already been processed fires on the next tick.
+ *
+ * The timer must have been initialized with timer_init or TIMER_INIT, and its
+ * memory must stay valid while it is pending.
+ *
+ * @param wheel Pointer to the wheel.
+ * @param timer Pointer to the timer.
+ * @param expires Tick at which the timer should fire.
+ * @param callback Function called when the timer fires. The timer is no longer
+ *                 pending when it is called, so it can add it again.
+ * @param arg User argument given to the callback.
+ *
+ * @return 0 if the timer was scheduled, 1 otherwise.
+ */
+int timer_wheel_add(TimerWheel * wheel, Timer * timer, uint64_t expires,
+                    void (*callback)(Timer * timer, void * arg), void * arg);
+
+/**
+ * @brief Cancels a pending timer.
+ *
+ * @param wheel Pointer to the wheel.
+ * @param timer Pointer to the timer.
+ *
+ * @return 0 if the timer was cancelled, 1 if it was not pending.
+ */
+int timer_wheel_cancel(TimerWheel * wheel, Timer * timer);
+
+/**
+ * @brief Advances the wheel up to a given tick, firing every timer that expires.
+ *
+ * Each elapsed tick cascades the higher level slots that became due and then
+ * fires the whole level 0 slot of that tick. Callbacks can add and cancel
+ * timers, including the ones due in the same tick.
+ *
+ * @param wheel Pointer to the wheel.
+ * @param now The current tick. Values lower than the last processed tick do nothing.
+ *
+ * @return The number of timers fired.
+ */
+int timer_wheel_tick(TimerWheel * wheel, uint64_t now);
+
+/**
+ * Macro to check whether a timer is pending.
+ */
+#define timer_pending(timer) ((timer)->slot != NULL)
+
+/**
+ * Macro to access the number of pending timers of a wheel.
+ */
+#define timer_wheel_num_timers(wheel) ((wheel)->num_timers)
+
+#endif
@@ -0,0 +1,141 @@
+#include "ws_deque.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+#define WS_DEQUE_ALLOCATION_ERROR "Memory allocation error for the work-stealing deque"
+
+#define WS_DEQUE_NULL_POINTER "Work-stealing deque pointer parameter is NULL"
+
+#define WS_DEQUE_MIN_CAPACITY 16
+
+static WsBuffer * buffer_alloc(int64_t size) {
+    WsBuffer * buffer = malloc(sizeof(WsBuffer) + size * sizeof(_Atomic(void *)));
+    if (!buffer) {
+        fputs(WS_DEQUE_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+    buffer->size = size;
+    buffer->retired = NULL;
+    return buffer;
+}
+
+#define SLOT(buffer, i) (&(buffer)->slots[(i) & ((buffer)->size - 1)])
+
+WsDeque * ws_deque_init(int capacity) {
+    WsDeque * deque = malloc(sizeof(WsDeque));
+    if (!deque) {
+        fputs(WS_DEQUE_ALLOCATION_ERROR, stderr);
+        return NULL;
+    }
+
+    int64_t size = WS_DEQUE_MIN_CAPACITY;
+    while (size < capacity)
+        size *= 2;
+
+    WsBuffer * buffer = buffer_alloc(size);
+    if (!buffer) {
+        free(deque);
+        return NULL;
+    }
+
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->buffer, buffer);
+
+    return deque;
+}
+
+void ws_deque_terminate(WsDeque * deque) {
+    if (!deque) {
+        fputs(WS_DEQUE_NULL_POINTER, stderr);
+        return;
+    }
+
+    WsBuffer * buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+    while (buffer) {
+        WsBuffer * retired = buffer->retired;
+        free(buffer);
+        buffer = retired;
+    }
+    free(deque);
+}
+
+/* Copies the live elements to a buffer twice as large. The old buffer is
+ * chained to the new one, since thieves may still be reading it. */
+static WsBuffer * grow(WsDeque * deque, WsBuffer * old, int64_t top, int64_t bottom) {
+    WsBuffer * buffer = buffer_alloc(old->size * 2);
+    if (!buffer)
+        return NULL;
+
+    for (int64_t i = top; i < bottom; i++)
+        atomic_store_explicit(SLOT(buffer, i),
+                              atomic_load_explicit(SLOT(old, i), memory_order_relaxed),
+                              memory_order_relaxed);
+
+    buffer->retired = old;
+    atomic_store_explicit(&deque->buffer, buffer, memory_order_release);
+    return buffer;
+}
+
+int ws_deque_push(WsDeque * deque, void * data) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    WsBuffer * buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+
+    if (bottom - top > buffer->size - 1) {
+        buffer = grow(deque, buffer, top, bottom);
+        if (!buffer)
+            return 1;
+    }
+
+    atomic_store_explicit(SLOT(buffer, bottom), data, memory_order_relaxed);
+    /* Release store instead of the paper's release fence plus relaxed store:
+     * same ordering, and visible to race detectors that ignore fences */
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+    return 0;
+}
+
+int ws_deque_take(WsDeque * deque, void ** out) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    WsBuffer * buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        /* Empty: restore bottom */
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return WS_DEQUE_EMPTY;
+    }
+
+    *out = atomic_load_explicit(SLOT(buffer, bottom), memory_order_relaxed);
+
+    if (top == bottom) {
+        /* Last element: race against thieves for it */
+        int won = atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                          memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return won ? WS_DEQUE_OK : WS_DEQUE_EMPTY;
+    }
+
+    return WS_DEQUE_OK;
+}
+
+int ws_deque_steal(WsDeque * deque, void ** out) {
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if (top >= bottom)
+        return WS_DEQUE_EMPTY;
+
+    WsBuffer * buffer = atomic_load_explicit(&deque->buffer, memory_order_acquire);
+    void * data = atomic_load_explicit(SLOT(buffer, top), memory_order_relaxed);
+
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed))
+        return WS_DEQUE_ABORT;
+
+    *out = data;
+    return WS_DEQUE_OK;
+}
@@ -0,0 +1,110 @@
+#ifndef WS_DEQUE_H
+#define WS_DEQUE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/**
+ * @file ws_deque.h
+ * @brief Chase-Lev work-stealing deque.
+ *
+ * A deque of pointers with a single owner thread and any number of thieves.
+ * The owner pushes and takes elements at the bottom, in LIFO order, which
+ * keeps recently spawned work hot in its cache. Thieves steal from the top,
+ * in FIFO order, so they take the oldest and usually largest pieces of work.
+ *
+ * Push and take are wait-free except when the buffer grows, and steal is
+ * lock-free. The implementation follows the C11 memory model version of
+ * Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing
+ * for Weak Memory Models" (PPoPP 2013).
+ *
+ * Buffers replaced by a growth may still be read by a concurrent thief, so
+ * they are kept until the deque is terminated.
+ */
+
+/**
+ * @brief Results of ws_deque_take and ws_deque_steal
+ */
+enum {
+    WS_DEQUE_OK = 0,        /**< An element was returned. */
+    WS_DEQUE_EMPTY = 1,     /**< The deque was empty. */
+    WS_DEQUE_ABORT = 2      /**< A steal lost a race with another thread; it may be retried. */
+};
+
+/**
+ * @brief Circular buffer of a deque
+ */
+typedef struct WsBuffer {
+    int64_t size;                   /**< Capacity, always a power of two. */
+    struct WsBuffer * retired;      /**< Older buffer replaced by this one, or NULL. */
+    _Atomic(void *) slots[];        /**< The elements. */
+} WsBuffer;
+
+/**
+ * @brief The deque structure
+ */
+typedef struct WsDeque {
+    _Atomic int64_t top;            /**< Index of the next element to steal. */
+    _Atomic int64_t bottom;         /**< Index of the next free slot. */
+    _Atomic(WsBuffer *) buffer;     /**< Current buffer. */
+} WsDeque;
+
+/**
+ * @brief Initializes a new deque
+ *
+ * @param capacity Initial capacity, rounded up to a power of two. The deque
+ *                 grows as needed.
+ *
+ * @return A pointer to the new deque, or NULL if memory allocation fails.
+ */
+WsDeque * ws_deque_init(int capacity);
+
+/**
+ * @brief Destroys the deque. No other thread may be using it.
+ *
+ * @param deque Pointer to the deque
+ */
+void ws_deque_terminate(WsDeque * deque);
+
+/**
+ * @brief Pushes an element at the bottom. Only the owner may call it.
+ *
+ * @param deque Pointer to the deque
+ *
+ * @param data The element to be pushed
+ *
+ * @return 0 if the element was pushed, 1 if the deque had to grow and memory
+ *         allocation failed.
+ */
+int ws_deque_push(WsDeque * deque, void * data);
+
+/**
+ * @brief Takes the element at the bottom. Only the owner may call it.
+ *
+ * @param deque Pointer to the deque
+ *
+ * @param out Where the element is stored
+ *
+ * @return WS_DEQUE_OK or WS_DEQUE_EMPTY
+ */
+int ws_deque_take(WsDeque * deque, void ** out);
+
+/**
+ * @brief Steals the element at the top. Any thread may call it.
+ *
+ * @param deque Pointer to the deque
+ *
+ * @param out Where the element is stored
+ *
+ * @return WS_DEQUE_OK, WS_DEQUE_EMPTY or WS_DEQUE_ABORT
+ */
+int ws_deque_steal(WsDeque * deque, void ** out);
+
+/**
+ * @brief Approximate number of elements, for heuristics only
+ */
+#define ws_deque_size(deque) \
+    (atomic_load_explicit(&(deque)->bottom, memory_order_relaxed) - \
+     atomic_load_explicit(&(deque)->top, memory_order_relaxed))
+
+#endif